@@ -1,8 +1,13 @@
+#include "../../Chapter14/radix_sort.h"
+#include "../../Chapter14/sort.h"
+
 #include <benchmark/benchmark.h>
 
 #include <algorithm>
 #include <random>
 #include <string>
+#include <thread>
+#include <tuple>
 #include <vector>
 #include <numeric>
 
@@ -59,10 +64,165 @@ void bm_partial_sort(benchmark::State& state) {
   }
 }
 
+// par_sort() and par_sample_sort() from Chapter14 on a pool with the
+// given number of threads, and with the given sequential cutoff
+
+constexpr auto default_cutoff = size_t{50'000};
+
+template <typename Sort>
+void bm_par_sort_impl(benchmark::State& state, size_t n_threads,
+                      size_t cutoff, Sort sort) {
+  const auto n = state.range(0);
+  auto r = create_ints(n);
+  auto rd = std::random_device{};
+  auto g = std::mt19937{rd()};
+  auto pool = WorkStealingPool{static_cast<unsigned>(n_threads)};
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::shuffle(std::begin(r), std::end(r), g);
+    state.ResumeTiming();
+
+    sort(pool, r.begin(), r.end(), std::less<>{}, cutoff);
+  }
+}
+
+void bm_par_sort(benchmark::State& state) {
+  bm_par_sort_impl(state, state.range(1), default_cutoff, [](auto&&... args) {
+    par_sort(args...);
+  });
+}
+
+void bm_par_sample_sort(benchmark::State& state) {
+  bm_par_sort_impl(state, state.range(1), default_cutoff, [](auto&&... args) {
+    par_sample_sort(args...);
+  });
+}
+
+void bm_par_sort_cutoff(benchmark::State& state) {
+  const auto n_threads = std::max(1u, std::thread::hardware_concurrency());
+  bm_par_sort_impl(state, n_threads, state.range(1), [](auto&&... args) {
+    par_sort(args...);
+  });
+}
+
+void bm_par_sample_sort_cutoff(benchmark::State& state) {
+  const auto n_threads = std::max(1u, std::thread::hardware_concurrency());
+  bm_par_sort_impl(state, n_threads, state.range(1), [](auto&&... args) {
+    par_sample_sort(args...);
+  });
+}
+
+// Radix sorts of ints, floats and players sorted by level and then score
+// like in Chapter09/example_projections.cpp, against std::sort()
+
+struct Player {
+  std::string name_;
+  int level_{};
+  int score_{};
+};
+
+auto create_floats(size_t n) {
+  auto v = std::vector<float>(n);
+  auto g = std::mt19937{std::random_device{}()};
+  auto dist = std::uniform_real_distribution<float>{-1e6f, 1e6f};
+  std::generate(v.begin(), v.end(), [&] { return dist(g); });
+  return v;
+}
+
+auto create_players(size_t n) {
+  auto players = std::vector<Player>{};
+  players.reserve(n);
+  auto g = std::mt19937{std::random_device{}()};
+  auto level = std::uniform_int_distribution<>{1, 100};
+  auto score = std::uniform_int_distribution<>{0, 100'000};
+  for (size_t i = 0; i < n; ++i) {
+    players.push_back({"Player", level(g), score(g)});
+  }
+  return players;
+}
+
+auto by_level_and_score(const Player& p) { return std::tie(p.level_, p.score_); }
+
+template <typename T, typename Sort>
+void bm_sort_values(benchmark::State& state, std::vector<T> r, Sort sort) {
+  auto g = std::mt19937{std::random_device{}()};
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::shuffle(std::begin(r), std::end(r), g);
+    state.ResumeTiming();
+
+    sort(r.begin(), r.end());
+  }
+  state.SetItemsProcessed(state.iterations() * r.size());
+}
+
+void bm_radix_sort(benchmark::State& state) {
+  bm_sort_values(state, create_ints(state.range(0)), [](auto f, auto l) {
+    par_radix_sort(f, l, std::identity{}, default_cutoff);
+  });
+}
+
+void bm_radix_sort_msd(benchmark::State& state) {
+  bm_sort_values(state, create_ints(state.range(0)), [](auto f, auto l) {
+    par_radix_sort_msd(f, l, std::identity{}, default_cutoff);
+  });
+}
+
+void bm_sort_floats(benchmark::State& state) {
+  bm_sort_values(state, create_floats(state.range(0)),
+                 [](auto f, auto l) { std::sort(f, l); });
+}
+
+void bm_radix_sort_floats(benchmark::State& state) {
+  bm_sort_values(state, create_floats(state.range(0)), [](auto f, auto l) {
+    par_radix_sort(f, l, std::identity{}, default_cutoff);
+  });
+}
+
+void bm_sort_players(benchmark::State& state) {
+  bm_sort_values(state, create_players(state.range(0)), [](auto f, auto l) {
+    std::sort(f, l, [](const Player& lhs, const Player& rhs) {
+      return by_level_and_score(lhs) < by_level_and_score(rhs);
+    });
+  });
+}
+
+void bm_radix_sort_players(benchmark::State& state) {
+  bm_sort_values(state, create_players(state.range(0)), [](auto f, auto l) {
+    par_radix_sort(f, l, by_level_and_score, default_cutoff);
+  });
+}
+
+void ScalingArguments(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"n", "threads"});
+  for (auto n_threads : {1, 2, 4, 8}) {
+    b->Args({10'000'000, n_threads});
+  }
+  b->UseRealTime()->Unit(benchmark::kMillisecond);
+}
+
+void CutoffArguments(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"n", "cutoff"});
+  for (auto cutoff : {1'000, 10'000, 100'000, 1'000'000}) {
+    b->Args({10'000'000, cutoff});
+  }
+  b->UseRealTime()->Unit(benchmark::kMillisecond);
+}
+
 } // namespace
 
 BENCHMARK(bm_sort)->Arg(10'000'000)->Unit(benchmark::kMillisecond);
 BENCHMARK(bm_median)->Arg(10'000'000)->Unit(benchmark::kMillisecond);
 BENCHMARK(bm_partial_sort)->Arg(10'000'000)->Unit(benchmark::kMillisecond);
+BENCHMARK(bm_par_sort)->Apply(ScalingArguments);
+BENCHMARK(bm_par_sample_sort)->Apply(ScalingArguments);
+BENCHMARK(bm_par_sort_cutoff)->Apply(CutoffArguments);
+BENCHMARK(bm_par_sample_sort_cutoff)->Apply(CutoffArguments);
+BENCHMARK(bm_radix_sort)->Arg(10'000'000)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(bm_radix_sort_msd)->Arg(10'000'000)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(bm_sort_floats)->Arg(10'000'000)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(bm_radix_sort_floats)->Arg(10'000'000)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(bm_sort_players)->Arg(10'000'000)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(bm_radix_sort_players)->Arg(10'000'000)->UseRealTime()->Unit(benchmark::kMillisecond);
 
 BENCHMARK_MAIN();
\ No newline at end of file
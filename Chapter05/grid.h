@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <ranges>
+#include <utility>
+#include <vector>
+
+template <typename T = int>
+struct Grid {
+  Grid(size_t w, size_t h) : w_{w}, h_{h} { data_.resize(w * h); }
+  auto get_row_v1(size_t y); // Returns iterator pairs
+  auto get_row_v2(size_t y); // Returns range using subrange
+  auto get_row_v3(size_t y); // Returns range using counted
+  std::vector<T> data_{};
+  size_t w_{};
+  size_t h_{};
+};
+
+template <typename T>
+auto Grid<T>::get_row_v1(size_t y) {
+  auto left = data_.begin() + w_ * y;
+  auto right = left + w_;
+  return std::make_pair(left, right);
+}
+
+template <typename T>
+auto Grid<T>::get_row_v2(size_t y) {
+  auto first = data_.begin() + w_ * y;
+  auto sentinel = first + w_;
+  return std::ranges::subrange{first, sentinel};
+}
+
+template <typename T>
+auto Grid<T>::get_row_v3(size_t y) {
+  auto first = data_.begin() + w_ * y;
+  return std::views::counted(first, w_);
+}
@@ -0,0 +1,304 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+// Thread safe allocation tracking. The global operator new and delete in
+// tracked_operator_new.h report every allocation here. Tracking is turned
+// on by an AllocationScope and when no scope is active the cost of an
+// allocation is a single relaxed load and a branch.
+//
+// Counters are kept per thread and summed when a snapshot is taken. Live
+// and peak bytes are process wide and measured relative to the start of
+// the outermost active scope.
+
+namespace alloc_tracker {
+
+// Size class k holds allocations of (2^(k-1), 2^k] bytes, the last class
+// also holds everything larger
+constexpr size_t n_size_classes = 33;
+
+constexpr auto size_class(size_t n) noexcept -> size_t {
+  return n <= 1 ? 0
+                : std::min(static_cast<size_t>(std::bit_width(n - 1)),
+                           n_size_classes - 1);
+}
+
+struct Stats {
+  size_t n_allocations{};
+  size_t n_deallocations{};
+  size_t bytes_allocated{};
+  size_t bytes_deallocated{};
+  size_t peak_live_bytes{};
+  std::array<size_t, n_size_classes> histogram{};
+};
+
+struct CallSite {
+  const void* address{};
+  size_t n_allocations{};
+  size_t bytes{};
+};
+
+namespace detail {
+
+// Only the owning thread writes to the counters, which therefore can be
+// updated without read-modify-write instructions
+struct ThreadCounters {
+  std::atomic<size_t> n_allocations{};
+  std::atomic<size_t> n_deallocations{};
+  std::atomic<size_t> bytes_allocated{};
+  std::atomic<size_t> bytes_deallocated{};
+  std::array<std::atomic<size_t>, n_size_classes> histogram{};
+  std::atomic<bool> in_use{true};
+  ThreadCounters* next{};
+};
+
+struct CallSiteSlot {
+  std::atomic<std::uintptr_t> address{};
+  std::atomic<size_t> n_allocations{};
+  std::atomic<size_t> bytes{};
+};
+
+inline std::atomic<int> n_active_scopes{0};
+inline std::atomic<bool> capture_call_sites{false};
+inline std::atomic<std::int64_t> live_bytes{0};
+inline std::atomic<std::int64_t> peak_live_bytes{0};
+inline std::atomic<ThreadCounters*> registry{nullptr};
+inline std::array<CallSiteSlot, 1024> call_sites{};
+
+// Set while the tracker itself is running on this thread. Registering the
+// thread local counters might allocate, which must not be recorded.
+inline thread_local bool is_recording{false};
+
+inline auto bump(std::atomic<size_t>& counter, size_t n) noexcept {
+  counter.store(counter.load(std::memory_order_relaxed) + n,
+                std::memory_order_relaxed);
+}
+
+// Counters of exited threads are adopted by new threads. The counters are
+// never freed, since a snapshot might be reading them.
+inline auto acquire_counters() noexcept -> ThreadCounters* {
+  for (auto* c = registry.load(); c != nullptr; c = c->next) {
+    auto expected = false;
+    if (c->in_use.compare_exchange_strong(expected, true)) {
+      return c;
+    }
+  }
+  // Use malloc() to not recurse into operator new
+  auto* mem = std::malloc(sizeof(ThreadCounters));
+  if (mem == nullptr) {
+    return nullptr;
+  }
+  auto* c = ::new (mem) ThreadCounters{};
+  c->next = registry.load();
+  while (!registry.compare_exchange_weak(c->next, c)) {
+  }
+  return c;
+}
+
+struct ThreadSlot {
+  ThreadCounters* counters_{acquire_counters()};
+  ~ThreadSlot() {
+    if (counters_ != nullptr) {
+      counters_->in_use.store(false);
+    }
+  }
+};
+
+inline auto local_counters() noexcept -> ThreadCounters* {
+  thread_local auto slot = ThreadSlot{};
+  return slot.counters_;
+}
+
+inline auto record_call_site(const void* site, size_t n) noexcept {
+  const auto address = reinterpret_cast<std::uintptr_t>(site);
+  const auto mask = call_sites.size() - 1;
+  for (auto i = size_t{0}; i < call_sites.size(); ++i) {
+    auto& slot = call_sites[(address / alignof(std::max_align_t) + i) & mask];
+    auto current = slot.address.load(std::memory_order_relaxed);
+    if (current == 0) {
+      // Claim the empty slot, unless another thread got there first
+      if (slot.address.compare_exchange_strong(current, address,
+                                               std::memory_order_relaxed)) {
+        current = address;
+      }
+    }
+    if (current == address) {
+      slot.n_allocations.fetch_add(1, std::memory_order_relaxed);
+      slot.bytes.fetch_add(n, std::memory_order_relaxed);
+      return;
+    }
+  }
+  // The table is full, the call site is dropped
+}
+
+} // namespace detail
+
+inline auto is_enabled() noexcept {
+  return detail::n_active_scopes.load(std::memory_order_relaxed) > 0;
+}
+
+inline auto record_allocation(size_t n, const void* site) noexcept {
+  if (!is_enabled() || detail::is_recording) {
+    return;
+  }
+  detail::is_recording = true;
+  if (auto* c = detail::local_counters(); c != nullptr) {
+    detail::bump(c->n_allocations, 1);
+    detail::bump(c->bytes_allocated, n);
+    detail::bump(c->histogram[size_class(n)], 1);
+  }
+  const auto size = static_cast<std::int64_t>(n);
+  const auto live =
+      detail::live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+  auto peak = detail::peak_live_bytes.load(std::memory_order_relaxed);
+  while (live > peak && !detail::peak_live_bytes.compare_exchange_weak(
+                            peak, live, std::memory_order_relaxed)) {
+  }
+  if (detail::capture_call_sites.load(std::memory_order_relaxed)) {
+    detail::record_call_site(site, n);
+  }
+  detail::is_recording = false;
+}
+
+inline auto record_deallocation(size_t n) noexcept {
+  if (!is_enabled() || detail::is_recording) {
+    return;
+  }
+  detail::is_recording = true;
+  if (auto* c = detail::local_counters(); c != nullptr) {
+    detail::bump(c->n_deallocations, 1);
+    detail::bump(c->bytes_deallocated, n);
+  }
+  detail::live_bytes.fetch_sub(static_cast<std::int64_t>(n),
+                               std::memory_order_relaxed);
+  detail::is_recording = false;
+}
+
+// Sum of the counters of all threads, peak_live_bytes is left as zero
+inline auto snapshot() noexcept -> Stats {
+  auto s = Stats{};
+  for (auto* c = detail::registry.load(); c != nullptr; c = c->next) {
+    s.n_allocations += c->n_allocations.load(std::memory_order_relaxed);
+    s.n_deallocations += c->n_deallocations.load(std::memory_order_relaxed);
+    s.bytes_allocated += c->bytes_allocated.load(std::memory_order_relaxed);
+    s.bytes_deallocated +=
+        c->bytes_deallocated.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < n_size_classes; ++i) {
+      s.histogram[i] += c->histogram[i].load(std::memory_order_relaxed);
+    }
+  }
+  return s;
+}
+
+inline auto set_capture_call_sites(bool capture) noexcept {
+  detail::capture_call_sites.store(capture);
+}
+
+inline auto reset_call_sites() noexcept {
+  for (auto& slot : detail::call_sites) {
+    slot.address.store(0, std::memory_order_relaxed);
+    slot.n_allocations.store(0, std::memory_order_relaxed);
+    slot.bytes.store(0, std::memory_order_relaxed);
+  }
+}
+
+// The call sites allocating the most bytes. The addresses are return
+// addresses into the calling code and can be resolved using for example
+// addr2line or a debugger.
+inline auto top_call_sites(size_t n) -> std::vector<CallSite> {
+  auto sites = std::vector<CallSite>{};
+  for (auto& slot : detail::call_sites) {
+    if (auto address = slot.address.load(std::memory_order_relaxed)) {
+      sites.push_back({reinterpret_cast<const void*>(address),
+                       slot.n_allocations.load(std::memory_order_relaxed),
+                       slot.bytes.load(std::memory_order_relaxed)});
+    }
+  }
+  const auto m = std::min(n, sites.size());
+  auto by_bytes = [](const auto& a, const auto& b) {
+    return a.bytes > b.bytes;
+  };
+  std::partial_sort(sites.begin(), sites.begin() + m, sites.end(), by_bytes);
+  sites.resize(m);
+  return sites;
+}
+
+} // namespace alloc_tracker
+
+// Enables tracking during its lifetime and reports the allocations made
+// since it was created. Scopes can be nested, for example one around a
+// whole test case and one around a single operation.
+class AllocationScope {
+public:
+  AllocationScope() noexcept {
+    using namespace alloc_tracker::detail;
+    n_active_scopes.fetch_add(1);
+    start_ = alloc_tracker::snapshot();
+    live_at_start_ = live_bytes.load();
+    saved_peak_ = peak_live_bytes.exchange(live_at_start_);
+  }
+  AllocationScope(const AllocationScope&) = delete;
+  AllocationScope& operator=(const AllocationScope&) = delete;
+  ~AllocationScope() { stop(); }
+
+  auto stop() noexcept -> void {
+    if (!stopped_) {
+      stats_ = stats();
+      stopped_ = true;
+      using namespace alloc_tracker::detail;
+      // Let an enclosing scope see the peak of this scope
+      auto peak = peak_live_bytes.load();
+      while (peak < saved_peak_ &&
+             !peak_live_bytes.compare_exchange_weak(peak, saved_peak_)) {
+      }
+      n_active_scopes.fetch_sub(1);
+    }
+  }
+
+  // The allocations since the scope was created, or until stop()
+  auto stats() const noexcept -> alloc_tracker::Stats {
+    if (stopped_) {
+      return stats_;
+    }
+    auto s = alloc_tracker::snapshot();
+    s.n_allocations -= start_.n_allocations;
+    s.n_deallocations -= start_.n_deallocations;
+    s.bytes_allocated -= start_.bytes_allocated;
+    s.bytes_deallocated -= start_.bytes_deallocated;
+    for (size_t i = 0; i < s.histogram.size(); ++i) {
+      s.histogram[i] -= start_.histogram[i];
+    }
+    const auto peak = alloc_tracker::detail::peak_live_bytes.load();
+    s.peak_live_bytes = static_cast<size_t>(
+        std::max(peak - live_at_start_, std::int64_t{0}));
+    return s;
+  }
+
+private:
+  alloc_tracker::Stats start_{};
+  alloc_tracker::Stats stats_{};
+  std::int64_t live_at_start_{};
+  std::int64_t saved_peak_{};
+  bool stopped_{false};
+};
+
+// Adds allocations per iteration to a Google Benchmark run, for example:
+//   auto scope = AllocationScope{};
+//   for (auto _ : state) { ... }
+//   report_allocations(state, scope.stats());
+template <typename State>
+auto report_allocations(State& state, const alloc_tracker::Stats& s) {
+  const auto n = static_cast<double>(std::max<decltype(state.iterations())>(
+      state.iterations(), 1));
+  state.counters["allocs/iter"] = static_cast<double>(s.n_allocations) / n;
+  state.counters["bytes/iter"] = static_cast<double>(s.bytes_allocated) / n;
+  state.counters["peak_bytes"] = static_cast<double>(s.peak_live_bytes);
+}
@@ -1,18 +1,54 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+
+// Arena with an inline buffer of N bytes. When the buffer is exhausted, the
+// arena grabs additional blocks of geometrically growing size from an
+// upstream memory resource instead of falling back to the global operator
+// new for every allocation. The blocks are kept in a linked list and are
+// reused after reset(), which therefore is O(1). Blocks are returned to the
+// upstream resource by release() or when the arena is destroyed.
 
 template <size_t N> class Arena {
 
   static constexpr size_t alignment = alignof(std::max_align_t);
+  static constexpr size_t growth_factor = 2;
+
+  struct Block {
+    Block* next_{};
+    size_t size_{}; // Usable bytes following the header
+    size_t used_{}; // Valid for blocks before the current block
+  };
+  static constexpr size_t header_size = (sizeof(Block) + alignment - 1) &
+                                        ~(alignment - 1);
 
 public:
-  Arena() noexcept : ptr_(buffer_) {}
+  struct BlockUsage {
+    size_t size{};
+    size_t used{};
+  };
+
+  Arena() noexcept : Arena(std::pmr::get_default_resource()) {}
+  explicit Arena(std::pmr::memory_resource* upstream) noexcept
+      : ptr_(buffer_), end_(buffer_ + N), upstream_(upstream) {}
   Arena(const Arena&) = delete;
   Arena& operator=(const Arena&) = delete;
+  ~Arena() { release(); }
 
-  auto reset() noexcept { ptr_ = buffer_; }
+  auto reset() noexcept {
+    current_ = nullptr;
+    ptr_ = buffer_;
+    end_ = buffer_ + N;
+  }
+  auto release() noexcept -> void;
   static constexpr auto size() noexcept { return N; }
-  auto used() const noexcept { return static_cast<size_t>(ptr_ - buffer_); }
+  auto used() const noexcept -> size_t;
+  auto block_count() const noexcept -> size_t;
+  template <typename F> auto for_each_block(F f) const -> void;
+  auto upstream_resource() const noexcept { return upstream_; }
   auto allocate(size_t n) -> std::byte*;
   auto deallocate(std::byte* p, size_t n) noexcept -> void;
 
@@ -20,34 +56,128 @@ private:
   static auto align_up(size_t n) noexcept -> size_t {
     return (n + (alignment - 1)) & ~(alignment - 1);
   }
-  auto pointer_in_buffer(const std::byte* p) const noexcept -> bool {
-    return std::uintptr_t(buffer_) <= std::uintptr_t(p) &&
-           std::uintptr_t(p) < std::uintptr_t(buffer_) + N;
+  static auto data(Block* b) noexcept -> std::byte* {
+    return reinterpret_cast<std::byte*>(b) + header_size;
   }
+  auto region_begin() const noexcept -> const std::byte* {
+    return current_ == nullptr ? buffer_ : data(current_);
+  }
+  auto pointer_in_region(const std::byte* p) const noexcept -> bool {
+    return std::uintptr_t(region_begin()) <= std::uintptr_t(p) &&
+           std::uintptr_t(p) < std::uintptr_t(ptr_);
+  }
+  auto next_block(size_t min_size) -> Block*;
+
   alignas(alignment) std::byte buffer_[N];
   std::byte* ptr_{};
+  std::byte* end_{};
+  size_t buffer_used_{}; // Valid when current_ != nullptr
+  Block* current_{};     // nullptr while allocating from buffer_
+  Block* head_{};        // First block in the chain
+  size_t next_block_size_{N * growth_factor};
+  std::pmr::memory_resource* upstream_{};
 };
 
 template <size_t N> auto Arena<N>::allocate(size_t n) -> std::byte* {
   const auto aligned_n = align_up(n);
-  const auto available_bytes =
-      static_cast<decltype(aligned_n)>(buffer_ + N - ptr_);
-  if (available_bytes >= aligned_n) {
-    auto* r = ptr_;
-    ptr_ += aligned_n;
-    return r;
-  }
-  return static_cast<std::byte*>(::operator new(n));
+  const auto available_bytes = static_cast<size_t>(end_ - ptr_);
+  if (available_bytes < aligned_n) {
+    // Close the current region and move on to a block that fits
+    auto* block = next_block(aligned_n);
+    if (current_ == nullptr) {
+      buffer_used_ = static_cast<size_t>(ptr_ - buffer_);
+    } else {
+      current_->used_ = static_cast<size_t>(ptr_ - data(current_));
+    }
+    current_ = block;
+    ptr_ = data(block);
+    end_ = ptr_ + block->size_;
+  }
+  auto* r = ptr_;
+  ptr_ += aligned_n;
+  return r;
 }
 
 template <size_t N>
 auto Arena<N>::deallocate(std::byte* p, size_t n) noexcept -> void {
-  if (pointer_in_buffer(p)) {
+  // Only the most recent allocation can be reclaimed, everything else is
+  // reclaimed by reset()
+  if (pointer_in_region(p)) {
     n = align_up(n);
     if (p + n == ptr_) {
       ptr_ = p;
     }
+  }
+}
+
+template <size_t N>
+auto Arena<N>::next_block(size_t min_size) -> Block* {
+  // Reuse blocks kept from before the last reset(), skipping the ones that
+  // are too small for this request
+  auto* prev = current_;
+  auto* b = current_ == nullptr ? head_ : current_->next_;
+  while (b != nullptr && b->size_ < min_size) {
+    b->used_ = 0;
+    prev = b;
+    b = b->next_;
+  }
+  if (b != nullptr) {
+    return b;
+  }
+  auto size = next_block_size_;
+  while (size < min_size) {
+    size *= growth_factor;
+  }
+  auto* mem = upstream_->allocate(header_size + size, alignment);
+  b = ::new (mem) Block{nullptr, size, 0};
+  next_block_size_ = size * growth_factor;
+  if (prev == nullptr) {
+    head_ = b;
   } else {
-    ::operator delete(p);
+    prev->next_ = b;
+  }
+  return b;
+}
+
+template <size_t N> auto Arena<N>::release() noexcept -> void {
+  reset();
+  for (auto* b = head_; b != nullptr;) {
+    auto* next = b->next_;
+    upstream_->deallocate(b, header_size + b->size_, alignment);
+    b = next;
+  }
+  head_ = nullptr;
+  next_block_size_ = N * growth_factor;
+}
+
+template <size_t N> auto Arena<N>::used() const noexcept -> size_t {
+  auto sum = size_t{0};
+  for_each_block([&sum](const BlockUsage& u) { sum += u.used; });
+  return sum;
+}
+
+template <size_t N> auto Arena<N>::block_count() const noexcept -> size_t {
+  auto count = size_t{1}; // The inline buffer
+  for (auto* b = head_; b != nullptr; b = b->next_) {
+    ++count;
+  }
+  return count;
+}
+
+// Visits the inline buffer followed by each block in the chain. Blocks after
+// the current one are kept for reuse and reported as unused.
+template <size_t N>
+template <typename F>
+auto Arena<N>::for_each_block(F f) const -> void {
+  const auto ptr_used = static_cast<size_t>(ptr_ - region_begin());
+  f(BlockUsage{N, current_ == nullptr ? ptr_used : buffer_used_});
+  auto passed_current = current_ == nullptr;
+  for (auto* b = head_; b != nullptr; b = b->next_) {
+    if (b == current_) {
+      f(BlockUsage{b->size_, ptr_used});
+      passed_current = true;
+    } else {
+      f(BlockUsage{b->size_, passed_current ? 0 : b->used_});
+    }
   }
 }
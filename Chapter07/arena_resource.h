@@ -0,0 +1,54 @@
+#pragma once
+
+#include "arena.h"
+
+#include <cstddef>
+#include <memory_resource>
+
+// Exposes an Arena as a std::pmr::memory_resource so that it can be used
+// with the pmr containers. Deallocating the most recent allocation rolls
+// back the arena, just like when using the arena directly. Over-aligned
+// requests are passed on to the upstream resource of the arena.
+
+template <size_t N>
+class ArenaResource : public std::pmr::memory_resource {
+public:
+  explicit ArenaResource(Arena<N>& arena) noexcept : arena_{&arena} {}
+  auto arena() const noexcept -> Arena<N>& { return *arena_; }
+
+private:
+  static constexpr auto max_alignment = alignof(std::max_align_t);
+
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+    if (alignment > max_alignment) {
+      return arena_->upstream_resource()->allocate(bytes, alignment);
+    }
+    return arena_->allocate(bytes);
+  }
+
+  void do_deallocate(void* p, std::size_t bytes,
+                     std::size_t alignment) override {
+    if (alignment > max_alignment) {
+      arena_->upstream_resource()->deallocate(p, bytes, alignment);
+    } else {
+      arena_->deallocate(static_cast<std::byte*>(p), bytes);
+    }
+  }
+
+  bool
+  do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+
+  Arena<N>* arena_{};
+};
+
+// Each thread gets its own arena and resource, which means that no
+// synchronization is needed when allocating from it. Memory allocated
+// from one thread must not be deallocated by another thread.
+template <size_t N>
+auto thread_arena_resource() -> ArenaResource<N>& {
+  thread_local Arena<N> arena{};
+  thread_local ArenaResource<N> resource{arena};
+  return resource;
+}
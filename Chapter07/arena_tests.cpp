@@ -0,0 +1,123 @@
+#include "arena.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <memory_resource>
+#include <new>
+#include <vector>
+
+namespace {
+
+// Upstream resource counting the blocks handed out to the arena
+class CountingResource : public std::pmr::memory_resource {
+public:
+  size_t n_allocations_{};
+  size_t n_deallocations_{};
+
+private:
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+    ++n_allocations_;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+  void do_deallocate(void* p, std::size_t bytes,
+                     std::size_t alignment) override {
+    ++n_deallocations_;
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+  }
+  bool
+  do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+};
+
+} // namespace
+
+TEST(Arena, AllocatesFromInlineBuffer) {
+  auto upstream = CountingResource{};
+  auto&& arena = Arena<256>{&upstream};
+  auto* p1 = arena.allocate(10);
+  auto* p2 = arena.allocate(10);
+  ASSERT_NE(p1, p2);
+  ASSERT_EQ(1, arena.block_count());
+  ASSERT_EQ(0, upstream.n_allocations_);
+  ASSERT_EQ(2 * alignof(std::max_align_t), arena.used());
+}
+
+TEST(Arena, GrowsGeometricallyFromUpstream) {
+  auto upstream = CountingResource{};
+  auto&& arena = Arena<64>{&upstream};
+  for (int i = 0; i < 100; ++i) {
+    arena.allocate(16);
+  }
+  ASSERT_EQ(arena.block_count() - 1, upstream.n_allocations_);
+
+  auto sizes = std::vector<size_t>{};
+  arena.for_each_block([&](auto u) { sizes.push_back(u.size); });
+  ASSERT_EQ(64, sizes.front());
+  for (size_t i = 1; i < sizes.size(); ++i) {
+    ASSERT_EQ(sizes[i - 1] * 2, sizes[i]);
+  }
+  ASSERT_EQ(100 * 16, arena.used());
+}
+
+TEST(Arena, LargeRequestGetsBlockThatFits) {
+  auto upstream = CountingResource{};
+  auto&& arena = Arena<64>{&upstream};
+  auto* p = arena.allocate(1000);
+  ASSERT_NE(nullptr, p);
+  ASSERT_EQ(2, arena.block_count());
+  auto last = Arena<64>::BlockUsage{};
+  arena.for_each_block([&](auto u) { last = u; });
+  ASSERT_GE(last.size, 1000);
+  ASSERT_EQ(1008, last.used);
+}
+
+TEST(Arena, ResetKeepsBlocksForReuse) {
+  auto upstream = CountingResource{};
+  auto&& arena = Arena<64>{&upstream};
+  for (int i = 0; i < 50; ++i) {
+    arena.allocate(32);
+  }
+  const auto n_blocks = arena.block_count();
+  const auto n_allocations = upstream.n_allocations_;
+  arena.reset();
+  ASSERT_EQ(0, arena.used());
+  ASSERT_EQ(n_blocks, arena.block_count());
+  for (int i = 0; i < 50; ++i) {
+    arena.allocate(32);
+  }
+  ASSERT_EQ(n_allocations, upstream.n_allocations_);
+  ASSERT_EQ(50 * 32, arena.used());
+}
+
+TEST(Arena, ReleaseReturnsBlocksToUpstream) {
+  auto upstream = CountingResource{};
+  {
+    auto&& arena = Arena<64>{&upstream};
+    for (int i = 0; i < 50; ++i) {
+      arena.allocate(32);
+    }
+    arena.release();
+    ASSERT_EQ(upstream.n_allocations_, upstream.n_deallocations_);
+    ASSERT_EQ(1, arena.block_count());
+    arena.allocate(128);
+  }
+  ASSERT_EQ(upstream.n_allocations_, upstream.n_deallocations_);
+}
+
+TEST(Arena, DeallocateLastAllocationInBlock) {
+  auto&& arena = Arena<64>{};
+  arena.allocate(48);
+  auto* p = arena.allocate(100); // Ends up in the first block
+  const auto used = arena.used();
+  arena.deallocate(p, 100);
+  ASSERT_EQ(used - 112, arena.used());
+  ASSERT_EQ(p, arena.allocate(100));
+}
+
+TEST(Arena, NullUpstreamThrows) {
+  auto&& arena = Arena<64>{std::pmr::null_memory_resource()};
+  arena.allocate(64);
+  ASSERT_THROW(arena.allocate(1), std::bad_alloc);
+}
@@ -0,0 +1,128 @@
+#include "../arena_resource.h"
+#include "../tracked_operator_new.h"
+
+#include <benchmark/benchmark.h>
+
+#include <memory_resource>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr auto arena_size = size_t{64 * 1024};
+
+auto create_random_ints(size_t n) {
+  auto engine = std::default_random_engine{42};
+  auto dist = std::uniform_int_distribution<int>{};
+  auto v = std::vector<int>(n);
+  for (auto& i : v) {
+    i = dist(engine);
+  }
+  return v;
+}
+
+auto fill_set(const std::vector<int>& src, std::pmr::memory_resource* mr) {
+  auto s = std::pmr::set<int>{mr};
+  for (auto i : src) {
+    s.insert(i);
+  }
+  benchmark::DoNotOptimize(s.size());
+}
+
+auto fill_vector(const std::vector<int>& src, std::pmr::memory_resource* mr) {
+  auto v = std::pmr::vector<int>{mr};
+  for (auto i : src) {
+    v.push_back(i);
+  }
+  benchmark::DoNotOptimize(v.data());
+}
+
+void bm_set_new_delete(benchmark::State& state) {
+  const auto src = create_random_ints(state.range(0));
+  auto scope = AllocationScope{};
+  for (auto _ : state) {
+    fill_set(src, std::pmr::new_delete_resource());
+  }
+  report_allocations(state, scope.stats());
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void bm_set_arena(benchmark::State& state) {
+  const auto src = create_random_ints(state.range(0));
+  auto&& arena = Arena<arena_size>{};
+  auto resource = ArenaResource<arena_size>{arena};
+  auto scope = AllocationScope{};
+  for (auto _ : state) {
+    fill_set(src, &resource);
+    arena.reset();
+  }
+  report_allocations(state, scope.stats());
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void bm_vector_new_delete(benchmark::State& state) {
+  const auto src = create_random_ints(state.range(0));
+  auto scope = AllocationScope{};
+  for (auto _ : state) {
+    fill_vector(src, std::pmr::new_delete_resource());
+  }
+  report_allocations(state, scope.stats());
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void bm_vector_arena(benchmark::State& state) {
+  const auto src = create_random_ints(state.range(0));
+  auto&& arena = Arena<arena_size>{};
+  auto resource = ArenaResource<arena_size>{arena};
+  auto scope = AllocationScope{};
+  for (auto _ : state) {
+    fill_vector(src, &resource);
+    arena.reset();
+  }
+  report_allocations(state, scope.stats());
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Every benchmark thread uses its own arena through the thread local
+// registry, which is compared against the shared global heap
+void bm_set_threads_new_delete(benchmark::State& state) {
+  const auto src = create_random_ints(state.range(0));
+  for (auto _ : state) {
+    fill_set(src, std::pmr::new_delete_resource());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void bm_set_threads_arena(benchmark::State& state) {
+  const auto src = create_random_ints(state.range(0));
+  auto& resource = thread_arena_resource<arena_size>();
+  for (auto _ : state) {
+    fill_set(src, &resource);
+    resource.arena().reset();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void CustomArguments(benchmark::internal::Benchmark* b) {
+  b->RangeMultiplier(10)->Range(100, 100'000)->Unit(benchmark::kMicrosecond);
+}
+
+void ThreadArguments(benchmark::internal::Benchmark* b) {
+  b->Arg(10'000)
+      ->ThreadRange(1, std::max(1u, std::thread::hardware_concurrency()))
+      ->UseRealTime()
+      ->Unit(benchmark::kMicrosecond);
+}
+
+} // namespace
+
+BENCHMARK(bm_set_new_delete)->Apply(CustomArguments);
+BENCHMARK(bm_set_arena)->Apply(CustomArguments);
+BENCHMARK(bm_vector_new_delete)->Apply(CustomArguments);
+BENCHMARK(bm_vector_arena)->Apply(CustomArguments);
+BENCHMARK(bm_set_threads_new_delete)->Apply(ThreadArguments);
+BENCHMARK(bm_set_threads_arena)->Apply(ThreadArguments);
+
+BENCHMARK_MAIN();
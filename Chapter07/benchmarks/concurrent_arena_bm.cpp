@@ -0,0 +1,58 @@
+#include "../concurrent_arena.h"
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <thread>
+
+namespace {
+
+auto&& user_arena = ConcurrentArena<1024 * 1024>{};
+
+// Uses the global operator new
+class HeapUser {
+  int id_{};
+};
+
+class ArenaUser {
+public:
+  auto operator new(size_t size) -> void* {
+    return user_arena.allocate(size);
+  }
+  auto operator delete(void* p) -> void {
+    user_arena.deallocate(static_cast<std::byte*>(p), sizeof(ArenaUser));
+  }
+
+private:
+  int id_{};
+};
+
+// Every thread creates a batch of users and deletes them in reverse order,
+// like request scoped objects
+template <typename User>
+void bm_create_users(benchmark::State& state) {
+  constexpr auto batch_size = 16;
+  auto users = std::array<User*, batch_size>{};
+  for (auto _ : state) {
+    for (auto& u : users) {
+      u = new User{};
+    }
+    benchmark::DoNotOptimize(users.data());
+    for (auto it = users.rbegin(); it != users.rend(); ++it) {
+      delete *it;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * batch_size);
+}
+
+void ThreadArguments(benchmark::internal::Benchmark* b) {
+  b->ThreadRange(1, std::max(1u, std::thread::hardware_concurrency()))
+      ->UseRealTime();
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(bm_create_users, HeapUser)->Apply(ThreadArguments);
+BENCHMARK_TEMPLATE(bm_create_users, ArenaUser)->Apply(ThreadArguments);
+
+BENCHMARK_MAIN();
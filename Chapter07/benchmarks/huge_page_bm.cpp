@@ -0,0 +1,111 @@
+#include "../arena.h"
+#include "../mapped_resource.h"
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <fstream>
+#include <memory>
+#include <string>
+
+//
+// Reruns the cache thrashing example from Chapter 4 with the matrix placed
+// in an arena backed by memory mappings, with and without huge pages. The
+// column-wise traversal touches a new page on every write, which makes the
+// number of TLB misses depend on the page size.
+//
+
+namespace {
+
+constexpr auto kL1CacheCapacity = 32768u;
+constexpr auto kSize = kL1CacheCapacity / sizeof(int);
+using MatrixType = std::array<std::array<int, kSize>, kSize>;
+
+auto cache_thrashing_fast(MatrixType& matrix) {
+  auto counter = 0;
+  for (auto i = 0u; i < kSize; ++i) {
+    for (auto j = 0u; j < kSize; ++j) {
+      matrix[i][j] = counter++;
+    }
+  }
+}
+
+auto cache_thrashing_slow(MatrixType& matrix) {
+  auto counter = 0;
+  for (auto i = 0u; i < kSize; ++i) {
+    for (auto j = 0u; j < kSize; ++j) {
+      matrix[j][i] = counter++; // Slow due to cache thrashing
+    }
+  }
+}
+
+// Anonymous memory of the process currently backed by transparent huge
+// pages, or 0 if unknown
+auto anon_huge_page_bytes() -> size_t {
+  auto in = std::ifstream{"/proc/self/smaps_rollup"};
+  auto key = std::string{};
+  auto kb = size_t{0};
+  while (in >> key) {
+    if (key == "AnonHugePages:" && in >> kb) {
+      return kb * 1024;
+    }
+  }
+  return 0;
+}
+
+template <typename F>
+void run(benchmark::State& state, MatrixType& matrix, F f) {
+  f(matrix); // Fault in all pages before measuring
+  for (auto _ : state) {
+    f(matrix);
+    benchmark::ClobberMemory();
+  }
+  state.counters["huge_page_MB"] =
+      static_cast<double>(anon_huge_page_bytes()) / (1024 * 1024);
+  state.SetBytesProcessed(state.iterations() * sizeof(MatrixType));
+}
+
+// Reference, the matrix allocated by operator new
+template <typename F> void bm_heap(benchmark::State& state, F f) {
+  auto matrix = std::make_unique<MatrixType>();
+  run(state, *matrix, f);
+}
+
+template <typename F>
+void bm_mapped_arena(benchmark::State& state, F f, bool huge_pages) {
+  auto resource = MappedResource{MappedResource::Options{huge_pages, true}};
+  auto&& arena = Arena<4096>{&resource};
+  auto* mem = arena.allocate(sizeof(MatrixType));
+  auto* matrix = ::new (mem) MatrixType;
+  run(state, *matrix, f);
+}
+
+void bm_fast_heap(benchmark::State& state) {
+  bm_heap(state, cache_thrashing_fast);
+}
+void bm_slow_heap(benchmark::State& state) {
+  bm_heap(state, cache_thrashing_slow);
+}
+void bm_fast_mapped(benchmark::State& state) {
+  bm_mapped_arena(state, cache_thrashing_fast, false);
+}
+void bm_slow_mapped(benchmark::State& state) {
+  bm_mapped_arena(state, cache_thrashing_slow, false);
+}
+void bm_fast_huge_pages(benchmark::State& state) {
+  bm_mapped_arena(state, cache_thrashing_fast, true);
+}
+void bm_slow_huge_pages(benchmark::State& state) {
+  bm_mapped_arena(state, cache_thrashing_slow, true);
+}
+
+} // namespace
+
+BENCHMARK(bm_fast_heap)->Unit(benchmark::kMillisecond);
+BENCHMARK(bm_fast_mapped)->Unit(benchmark::kMillisecond);
+BENCHMARK(bm_fast_huge_pages)->Unit(benchmark::kMillisecond);
+BENCHMARK(bm_slow_heap)->Unit(benchmark::kMillisecond);
+BENCHMARK(bm_slow_mapped)->Unit(benchmark::kMillisecond);
+BENCHMARK(bm_slow_huge_pages)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,177 @@
+#include "../slab_pool.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <forward_list>
+#include <fstream>
+#include <list>
+#include <map>
+#include <random>
+#include <set>
+#include <vector>
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Resident set size of the process, or 0 if not available. The growth is
+// measured while the live keys are still in the container. Note that memory
+// freed by earlier benchmarks may be reused, run one benchmark at a time
+// using --benchmark_filter for exact numbers.
+auto resident_bytes() -> size_t {
+#if defined(__linux__)
+  auto statm = std::ifstream{"/proc/self/statm"};
+  auto size = size_t{0};
+  auto resident = size_t{0};
+  statm >> size >> resident;
+  return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#else
+  return 0;
+#endif
+}
+
+auto resident_growth(size_t before) -> size_t {
+  const auto now = resident_bytes();
+  return now > before ? now - before : 0;
+}
+
+auto create_random_keys(size_t n) {
+  auto engine = std::default_random_engine{42};
+  auto dist = std::uniform_int_distribution<int>{};
+  auto v = std::vector<int>(n);
+  for (auto& i : v) {
+    i = dist(engine);
+  }
+  return v;
+}
+
+constexpr auto n_live = size_t{100'000};    // Live keys during the churn
+constexpr auto n_churn = size_t{1'000'000}; // Keys inserted and erased
+
+// Keeps n_live keys alive while inserting and erasing n_churn keys
+template <typename Set>
+void churn_set(Set& set, const std::vector<int>& keys) {
+  for (size_t i = 0; i < n_live; ++i) {
+    set.insert(keys[i]);
+  }
+  for (size_t i = n_live; i < keys.size(); ++i) {
+    set.erase(keys[i - n_live]);
+    set.insert(keys[i]);
+  }
+}
+
+template <typename Map>
+void churn_map(Map& map, const std::vector<int>& keys) {
+  for (size_t i = 0; i < n_live; ++i) {
+    map.emplace(keys[i], i);
+  }
+  for (size_t i = n_live; i < keys.size(); ++i) {
+    map.erase(keys[i - n_live]);
+    map.emplace(keys[i], i);
+  }
+}
+
+template <typename List>
+void churn_list(List& list, const std::vector<int>& keys) {
+  for (size_t i = 0; i < n_live; ++i) {
+    list.push_back(keys[i]);
+  }
+  for (size_t i = n_live; i < keys.size(); ++i) {
+    list.pop_front();
+    list.push_back(keys[i]);
+  }
+}
+
+template <typename ForwardList>
+void churn_forward_list(ForwardList& list, const std::vector<int>& keys) {
+  for (size_t i = 0; i < n_live; ++i) {
+    list.push_front(keys[i]);
+  }
+  for (size_t i = n_live; i < keys.size(); ++i) {
+    list.pop_front();
+    list.push_front(keys[i]);
+  }
+}
+
+template <typename Container, typename Churn>
+void run_std(benchmark::State& state, Churn churn) {
+  const auto keys = create_random_keys(n_live + n_churn);
+  const auto rss_before = resident_bytes();
+  auto rss_growth = size_t{0};
+  for (auto _ : state) {
+    auto c = Container{};
+    churn(c, keys);
+    rss_growth = std::max(rss_growth, resident_growth(rss_before));
+  }
+  state.SetItemsProcessed(state.iterations() * 2 * n_churn);
+  state.counters["rss_growth_kb"] = rss_growth / 1024.0;
+}
+
+template <typename Container, typename Churn>
+void run_pool(benchmark::State& state, Churn churn) {
+  const auto keys = create_random_keys(n_live + n_churn);
+  const auto rss_before = resident_bytes();
+  auto pool = SlabPool{};
+  auto rss_growth = size_t{0};
+  for (auto _ : state) {
+    auto c = Container{pool};
+    churn(c, keys);
+    rss_growth = std::max(rss_growth, resident_growth(rss_before));
+  }
+  state.SetItemsProcessed(state.iterations() * 2 * n_churn);
+  state.counters["rss_growth_kb"] = rss_growth / 1024.0;
+  state.counters["pool_kb"] = pool.resident() / 1024.0;
+}
+
+using StdSet = std::set<int>;
+using PoolSet = std::set<int, std::less<int>, PoolAlloc<int>>;
+using StdMap = std::map<int, size_t>;
+using PoolMap = std::map<int, size_t, std::less<int>,
+                         PoolAlloc<std::pair<const int, size_t>>>;
+using StdList = std::list<int>;
+using PoolList = std::list<int, PoolAlloc<int>>;
+using StdForwardList = std::forward_list<int>;
+using PoolForwardList = std::forward_list<int, PoolAlloc<int>>;
+
+void bm_set_std_allocator(benchmark::State& state) {
+  run_std<StdSet>(state, [](auto& c, auto& k) { churn_set(c, k); });
+}
+void bm_set_slab_pool(benchmark::State& state) {
+  run_pool<PoolSet>(state, [](auto& c, auto& k) { churn_set(c, k); });
+}
+void bm_map_std_allocator(benchmark::State& state) {
+  run_std<StdMap>(state, [](auto& c, auto& k) { churn_map(c, k); });
+}
+void bm_map_slab_pool(benchmark::State& state) {
+  run_pool<PoolMap>(state, [](auto& c, auto& k) { churn_map(c, k); });
+}
+void bm_list_std_allocator(benchmark::State& state) {
+  run_std<StdList>(state, [](auto& c, auto& k) { churn_list(c, k); });
+}
+void bm_list_slab_pool(benchmark::State& state) {
+  run_pool<PoolList>(state, [](auto& c, auto& k) { churn_list(c, k); });
+}
+void bm_forward_list_std_allocator(benchmark::State& state) {
+  run_std<StdForwardList>(
+      state, [](auto& c, auto& k) { churn_forward_list(c, k); });
+}
+void bm_forward_list_slab_pool(benchmark::State& state) {
+  run_pool<PoolForwardList>(
+      state, [](auto& c, auto& k) { churn_forward_list(c, k); });
+}
+
+} // namespace
+
+BENCHMARK(bm_set_std_allocator)->Unit(benchmark::kMillisecond);
+BENCHMARK(bm_set_slab_pool)->Unit(benchmark::kMillisecond);
+BENCHMARK(bm_map_std_allocator)->Unit(benchmark::kMillisecond);
+BENCHMARK(bm_map_slab_pool)->Unit(benchmark::kMillisecond);
+BENCHMARK(bm_list_std_allocator)->Unit(benchmark::kMillisecond);
+BENCHMARK(bm_list_slab_pool)->Unit(benchmark::kMillisecond);
+BENCHMARK(bm_forward_list_std_allocator)->Unit(benchmark::kMillisecond);
+BENCHMARK(bm_forward_list_slab_pool)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,131 @@
+#include "../small_string.h"
+#include "../small_vector.h"
+#include "../tracked_operator_new.h"
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr auto string_capacity = size_t{32};
+constexpr auto vector_capacity = size_t{16};
+
+using String = SmallString<string_capacity>;
+using Vector = SmallVector<int, vector_capacity>;
+
+// Build
+
+template <typename S>
+void bm_string_build(benchmark::State& state) {
+  const auto chars = std::string(state.range(0), 'x');
+  auto scope = AllocationScope{};
+  for (auto _ : state) {
+    auto s = S{chars.c_str()};
+    benchmark::DoNotOptimize(s.data());
+  }
+  report_allocations(state, scope.stats());
+}
+
+template <typename V>
+void bm_vector_build(benchmark::State& state) {
+  const auto n = static_cast<int>(state.range(0));
+  auto scope = AllocationScope{};
+  for (auto _ : state) {
+    auto v = V{};
+    for (int i = 0; i < n; ++i) {
+      v.push_back(i);
+    }
+    benchmark::DoNotOptimize(v.data());
+  }
+  report_allocations(state, scope.stats());
+}
+
+// Copy
+
+template <typename S>
+void bm_string_copy(benchmark::State& state) {
+  const auto src = S{std::string(state.range(0), 'x').c_str()};
+  auto scope = AllocationScope{};
+  for (auto _ : state) {
+    auto s = src;
+    benchmark::DoNotOptimize(s.data());
+  }
+  report_allocations(state, scope.stats());
+}
+
+template <typename V>
+void bm_vector_copy(benchmark::State& state) {
+  auto src = V{};
+  for (int i = 0; i < state.range(0); ++i) {
+    src.push_back(i);
+  }
+  auto scope = AllocationScope{};
+  for (auto _ : state) {
+    auto v = src;
+    benchmark::DoNotOptimize(v.data());
+  }
+  report_allocations(state, scope.stats());
+}
+
+// Move, two moves per iteration to get back to the original object
+
+template <typename S>
+void bm_string_move(benchmark::State& state) {
+  auto a = S{std::string(state.range(0), 'x').c_str()};
+  auto scope = AllocationScope{};
+  for (auto _ : state) {
+    auto b = std::move(a);
+    a = std::move(b);
+    benchmark::DoNotOptimize(a.data());
+  }
+  report_allocations(state, scope.stats());
+}
+
+template <typename V>
+void bm_vector_move(benchmark::State& state) {
+  auto a = V{};
+  for (int i = 0; i < state.range(0); ++i) {
+    a.push_back(i);
+  }
+  auto scope = AllocationScope{};
+  for (auto _ : state) {
+    auto b = std::move(a);
+    a = std::move(b);
+    benchmark::DoNotOptimize(a.data());
+  }
+  report_allocations(state, scope.stats());
+}
+
+// Sizes just below, at and just above the inline capacity
+void StringSizes(benchmark::internal::Benchmark* b) {
+  for (auto n : {8ul, 15ul, 16ul, 31ul, 32ul, 33ul, 64ul}) {
+    b->Arg(n);
+  }
+}
+
+void VectorSizes(benchmark::internal::Benchmark* b) {
+  for (auto n : {4ul, 15ul, 16ul, 17ul, 32ul}) {
+    b->Arg(n);
+  }
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(bm_string_build, std::string)->Apply(StringSizes);
+BENCHMARK_TEMPLATE(bm_string_build, String)->Apply(StringSizes);
+BENCHMARK_TEMPLATE(bm_string_copy, std::string)->Apply(StringSizes);
+BENCHMARK_TEMPLATE(bm_string_copy, String)->Apply(StringSizes);
+BENCHMARK_TEMPLATE(bm_string_move, std::string)->Apply(StringSizes);
+BENCHMARK_TEMPLATE(bm_string_move, String)->Apply(StringSizes);
+
+BENCHMARK_TEMPLATE(bm_vector_build, std::vector<int>)->Apply(VectorSizes);
+BENCHMARK_TEMPLATE(bm_vector_build, Vector)->Apply(VectorSizes);
+BENCHMARK_TEMPLATE(bm_vector_copy, std::vector<int>)->Apply(VectorSizes);
+BENCHMARK_TEMPLATE(bm_vector_copy, Vector)->Apply(VectorSizes);
+BENCHMARK_TEMPLATE(bm_vector_move, std::vector<int>)->Apply(VectorSizes);
+BENCHMARK_TEMPLATE(bm_vector_move, Vector)->Apply(VectorSizes);
+
+BENCHMARK_MAIN();
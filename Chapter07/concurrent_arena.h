@@ -0,0 +1,139 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+// A thread safe version of Arena. Large allocations bump a shared atomic
+// offset with a CAS loop. Small allocations are served from a per-thread
+// magazine, a chunk of the buffer claimed by a single bump, which means
+// that most allocations do not touch any shared cache line at all. When
+// the buffer is exhausted, the memory is taken from an upstream resource,
+// which therefore must be thread safe.
+//
+// Deallocating the most recent allocation of a magazine (or of the shared
+// buffer) rolls back the bump pointer, anything else is reclaimed by
+// reset(). reset() must not be called while other threads use the arena.
+
+template <size_t N> class ConcurrentArena {
+
+  static constexpr size_t alignment = alignof(std::max_align_t);
+
+public:
+  static constexpr size_t max_small_size = 256;
+  static constexpr size_t magazine_size = std::min(size_t{4096}, N / 16);
+
+  ConcurrentArena() noexcept
+      : ConcurrentArena(std::pmr::get_default_resource()) {}
+  explicit ConcurrentArena(std::pmr::memory_resource* upstream) noexcept
+      : id_{next_id()}, upstream_{upstream} {}
+  ConcurrentArena(const ConcurrentArena&) = delete;
+  ConcurrentArena& operator=(const ConcurrentArena&) = delete;
+
+  auto reset() noexcept {
+    offset_.store(0, std::memory_order_relaxed);
+    id_.store(next_id(), std::memory_order_relaxed); // Orphans all magazines
+  }
+  static constexpr auto size() noexcept { return N; }
+  // Bytes claimed from the buffer, including unused parts of magazines
+  auto used() const noexcept { return offset_.load(std::memory_order_relaxed); }
+  auto allocate(size_t n) -> std::byte*;
+  auto deallocate(std::byte* p, size_t n) noexcept -> void;
+
+private:
+  struct Magazine {
+    size_t owner_id_{0}; // No arena has id 0
+    std::byte* ptr_{};
+    std::byte* end_{};
+  };
+
+  // One magazine per thread, shared by all arenas of size N. A thread that
+  // alternates between two arenas of the same size simply grabs a new one.
+  static auto local_magazine() noexcept -> Magazine& {
+    thread_local auto magazine = Magazine{};
+    return magazine;
+  }
+  // Ids are never reused, unlike addresses. An arena created where another
+  // one was destroyed must not adopt the magazines of the old one.
+  static auto next_id() noexcept -> size_t {
+    static auto counter = std::atomic<size_t>{0};
+    return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+  }
+  static auto align_up(size_t n) noexcept -> size_t {
+    return (n + (alignment - 1)) & ~(alignment - 1);
+  }
+  auto pointer_in_buffer(const std::byte* p) const noexcept -> bool {
+    return std::uintptr_t(buffer_) <= std::uintptr_t(p) &&
+           std::uintptr_t(p) < std::uintptr_t(buffer_) + N;
+  }
+  auto is_owned(const Magazine& m) const noexcept {
+    return m.owner_id_ == id_.load(std::memory_order_relaxed);
+  }
+  static auto is_small(size_t aligned_n) noexcept {
+    return aligned_n <= max_small_size && aligned_n <= magazine_size;
+  }
+  // The offset is only bumped if n bytes fit, so a request that is too
+  // large does not waste the rest of the buffer for smaller ones
+  auto claim(size_t n) noexcept -> std::byte* {
+    auto offset = offset_.load(std::memory_order_relaxed);
+    do {
+      if (n > N - offset) {
+        return nullptr;
+      }
+    } while (!offset_.compare_exchange_weak(offset, offset + n,
+                                            std::memory_order_relaxed));
+    return buffer_ + offset;
+  }
+
+  alignas(alignment) std::byte buffer_[N];
+  alignas(64) std::atomic<size_t> offset_{0};
+  std::atomic<size_t> id_{};
+  std::pmr::memory_resource* upstream_{};
+  static_assert(std::atomic<size_t>::is_always_lock_free);
+};
+
+template <size_t N>
+auto ConcurrentArena<N>::allocate(size_t n) -> std::byte* {
+  const auto aligned_n = align_up(n);
+  if (is_small(aligned_n)) {
+    auto& m = local_magazine();
+    if (!is_owned(m) || static_cast<size_t>(m.end_ - m.ptr_) < aligned_n) {
+      // Refill, the remainder of the previous magazine is left unused
+      m = Magazine{};
+      if (auto* p = claim(magazine_size); p != nullptr) {
+        m = Magazine{id_.load(std::memory_order_relaxed), p,
+                     p + magazine_size};
+      }
+    }
+    if (m.ptr_ != nullptr) {
+      auto* r = m.ptr_;
+      m.ptr_ += aligned_n;
+      return r;
+    }
+  } else if (auto* p = claim(aligned_n); p != nullptr) {
+    return p;
+  }
+  return static_cast<std::byte*>(upstream_->allocate(aligned_n, alignment));
+}
+
+template <size_t N>
+auto ConcurrentArena<N>::deallocate(std::byte* p, size_t n) noexcept
+    -> void {
+  const auto aligned_n = align_up(n);
+  if (!pointer_in_buffer(p)) {
+    upstream_->deallocate(p, aligned_n, alignment);
+    return;
+  }
+  if (is_small(aligned_n)) {
+    if (auto& m = local_magazine(); is_owned(m) && p + aligned_n == m.ptr_) {
+      m.ptr_ = p;
+    }
+  } else {
+    // Roll back the shared offset if no one has claimed memory after us
+    auto expected = static_cast<size_t>(p - buffer_) + aligned_n;
+    offset_.compare_exchange_strong(expected, expected - aligned_n,
+                                    std::memory_order_relaxed);
+  }
+}
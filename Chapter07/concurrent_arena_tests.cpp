@@ -0,0 +1,89 @@
+#include "concurrent_arena.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <thread>
+#include <vector>
+
+TEST(ConcurrentArena, SmallAllocationsUseMagazine) {
+  auto&& arena = ConcurrentArena<64 * 1024>{};
+  auto* p1 = arena.allocate(16);
+  auto* p2 = arena.allocate(16);
+  ASSERT_EQ(p1 + 16, p2);
+  ASSERT_EQ(arena.magazine_size, arena.used());
+  arena.deallocate(p2, 16);
+  ASSERT_EQ(p2, arena.allocate(16)); // Rolled back within the magazine
+}
+
+TEST(ConcurrentArena, LargeAllocationsRollBack) {
+  auto&& arena = ConcurrentArena<64 * 1024>{};
+  auto* p = arena.allocate(1000);
+  ASSERT_EQ(1008, arena.used());
+  arena.deallocate(p, 1000);
+  ASSERT_EQ(0, arena.used());
+}
+
+TEST(ConcurrentArena, FallsBackToUpstream) {
+  auto&& arena = ConcurrentArena<4096>{};
+  auto* p1 = arena.allocate(4096);
+  auto* p2 = arena.allocate(64); // Does not fit in the buffer
+  ASSERT_EQ(4096, arena.used());
+  arena.deallocate(p2, 64);
+  arena.deallocate(p1, 4096);
+}
+
+TEST(ConcurrentArena, OversizedAllocationDoesNotExhaustBuffer) {
+  auto&& arena = ConcurrentArena<4096>{};
+  auto* large = arena.allocate(8192); // Taken from upstream
+  ASSERT_EQ(0, arena.used());
+  auto* p = arena.allocate(1000);
+  ASSERT_EQ(1008, arena.used()); // Still served from the buffer
+  arena.deallocate(p, 1000);
+  arena.deallocate(large, 8192);
+  ASSERT_EQ(0, arena.used());
+}
+
+TEST(ConcurrentArena, RecreatedArenaDoesNotReuseMagazine) {
+  using ArenaType = ConcurrentArena<64 * 1024>;
+  alignas(ArenaType) static std::byte storage[sizeof(ArenaType)];
+  auto* arena = ::new (storage) ArenaType{};
+  arena->allocate(16); // Gives this thread a magazine of the first arena
+  arena->~ArenaType();
+
+  arena = ::new (storage) ArenaType{};
+  auto* large = arena->allocate(1000);
+  auto* small = arena->allocate(16); // Must not use the old magazine
+  ASSERT_TRUE(small + 16 <= large || large + 1008 <= small);
+  ASSERT_EQ(1008 + arena->magazine_size, arena->used());
+  arena->~ArenaType();
+}
+
+TEST(ConcurrentArena, AllocateFromManyThreads) {
+  constexpr auto n_threads = 4;
+  constexpr auto n = 1000;
+  auto&& arena = ConcurrentArena<1024 * 1024>{};
+  auto ptrs = std::vector<std::vector<std::byte*>>(n_threads);
+  auto threads = std::vector<std::thread>{};
+  for (auto i = 0; i < n_threads; ++i) {
+    threads.emplace_back([&arena, &ptrs, i] {
+      for (auto j = 0; j < n; ++j) {
+        ptrs[i].push_back(arena.allocate(32));
+      }
+    });
+  }
+  for (auto&& t : threads) {
+    t.join();
+  }
+  auto all = std::vector<std::byte*>{};
+  for (auto&& v : ptrs) {
+    all.insert(all.end(), v.begin(), v.end());
+  }
+  std::sort(all.begin(), all.end());
+  // No two allocations may overlap
+  for (size_t i = 1; i < all.size(); ++i) {
+    ASSERT_GE(all[i] - all[i - 1], 32);
+  }
+}
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+
+#if __has_include(<sys/mman.h>) && __has_include(<unistd.h>)
+#include <sys/mman.h>
+#include <unistd.h>
+#define MAPPED_RESOURCE_HAS_MMAP 1
+#else
+#define MAPPED_RESOURCE_HAS_MMAP 0
+#endif
+
+// Memory resource handing out memory mapped directly from the operating
+// system, intended as the upstream of an Arena holding large scratch
+// buffers. Each allocation is a separate anonymous mapping which is
+// returned to the system on deallocation.
+//
+// With huge pages enabled, mappings of at least one huge page are aligned
+// to the huge page size and advised with MADV_HUGEPAGE, which lets the
+// kernel back them with transparent huge pages and cuts the number of TLB
+// entries needed by a factor of 512 on x86-64. If the kernel refuses, the
+// mapping is still usable with normal pages. Without mmap, the resource
+// falls back to its upstream resource.
+
+class MappedResource : public std::pmr::memory_resource {
+public:
+  static constexpr size_t huge_page_size = size_t{2} * 1024 * 1024;
+
+  struct Options {
+    bool huge_pages{true}; // Advise the kernel to use huge pages
+    bool populate{true};   // Fault in all pages up front
+  };
+
+  MappedResource() noexcept : MappedResource(Options{}) {}
+  explicit MappedResource(
+      Options options,
+      std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+      : options_{options}, upstream_{upstream} {}
+
+  auto options() const noexcept { return options_; }
+  auto mapped_bytes() const noexcept { return mapped_bytes_; }
+  // Bytes of the mappings that were successfully advised to use huge pages
+  auto huge_page_bytes() const noexcept { return huge_page_bytes_; }
+
+private:
+  auto do_allocate(size_t bytes, size_t alignment) -> void* override;
+  auto do_deallocate(void* p, size_t bytes, size_t alignment)
+      -> void override;
+  auto do_is_equal(const std::pmr::memory_resource& other) const noexcept
+      -> bool override {
+    return this == &other;
+  }
+
+  static auto round_up(size_t n, size_t multiple) noexcept {
+    return (n + multiple - 1) / multiple * multiple;
+  }
+  auto use_huge_pages(size_t bytes) const noexcept {
+    return options_.huge_pages && bytes >= huge_page_size;
+  }
+  static auto page_size() noexcept -> size_t;
+  auto granularity(size_t bytes) const noexcept -> size_t;
+  auto mapping_size(size_t bytes) const noexcept {
+    return round_up(bytes, granularity(bytes));
+  }
+  auto map(size_t size) -> std::byte*;
+
+  Options options_{};
+  std::pmr::memory_resource* upstream_{};
+  size_t mapped_bytes_{};
+  size_t huge_page_bytes_{};
+};
+
+#if MAPPED_RESOURCE_HAS_MMAP
+
+inline auto MappedResource::page_size() noexcept -> size_t {
+  static const auto size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+  return size;
+}
+
+inline auto MappedResource::granularity(size_t bytes) const noexcept
+    -> size_t {
+  return use_huge_pages(bytes) ? huge_page_size : page_size();
+}
+
+inline auto MappedResource::map(size_t size) -> std::byte* {
+  const auto huge = use_huge_pages(size);
+  // Huge pages must be aligned to the huge page size, so map an extra huge
+  // page and trim the ends. MAP_POPULATE is only used for normal pages,
+  // since it would fault the pages in before madvise() has been called.
+  const auto reserved = huge ? size + huge_page_size : size;
+  auto flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef MAP_POPULATE
+  if (options_.populate && !huge) {
+    flags |= MAP_POPULATE;
+  }
+#endif
+  auto* mem = ::mmap(nullptr, reserved, PROT_READ | PROT_WRITE, flags, -1, 0);
+  if (mem == MAP_FAILED) {
+    throw std::bad_alloc{};
+  }
+  auto* p = static_cast<std::byte*>(mem);
+  if (!huge) {
+    return p;
+  }
+  const auto address = reinterpret_cast<std::uintptr_t>(p);
+  auto* aligned = p + (round_up(address, huge_page_size) - address);
+  if (auto head = static_cast<size_t>(aligned - p); head > 0) {
+    ::munmap(p, head);
+  }
+  if (auto tail = static_cast<size_t>((p + reserved) - (aligned + size));
+      tail > 0) {
+    ::munmap(aligned + size, tail);
+  }
+#ifdef MADV_HUGEPAGE
+  if (::madvise(aligned, size, MADV_HUGEPAGE) == 0) {
+    huge_page_bytes_ += size;
+  }
+#endif
+  if (options_.populate) {
+#ifdef MADV_POPULATE_WRITE
+    if (::madvise(aligned, size, MADV_POPULATE_WRITE) == 0) {
+      return aligned;
+    }
+#endif
+    // Older kernels, touch one byte per page. Even if MADV_HUGEPAGE was
+    // accepted, the kernel may have no huge page to spare and fall back to
+    // normal pages. Touching an already faulted page is only a store.
+    for (auto i = size_t{0}; i < size; i += page_size()) {
+      static_cast<volatile std::byte*>(aligned)[i] = std::byte{0};
+    }
+  }
+  return aligned;
+}
+
+inline auto MappedResource::do_allocate(size_t bytes, size_t alignment)
+    -> void* {
+  // Mappings are aligned to their granularity, which covers any sensible
+  // alignment
+  if (alignment > granularity(bytes)) {
+    return upstream_->allocate(bytes, alignment);
+  }
+  const auto size = mapping_size(bytes);
+  auto* p = map(size);
+  mapped_bytes_ += size;
+  return p;
+}
+
+inline auto MappedResource::do_deallocate(void* p, size_t bytes,
+                                          size_t alignment) -> void {
+  if (alignment > granularity(bytes)) {
+    upstream_->deallocate(p, bytes, alignment);
+    return;
+  }
+  const auto size = mapping_size(bytes);
+  if (use_huge_pages(size)) {
+    huge_page_bytes_ -= std::min(huge_page_bytes_, size);
+  }
+  ::munmap(p, size);
+  mapped_bytes_ -= size;
+}
+
+#else
+
+inline auto MappedResource::granularity(size_t) const noexcept -> size_t {
+  return alignof(std::max_align_t);
+}
+
+inline auto MappedResource::do_allocate(size_t bytes, size_t alignment)
+    -> void* {
+  return upstream_->allocate(bytes, alignment);
+}
+
+inline auto MappedResource::do_deallocate(void* p, size_t bytes,
+                                          size_t alignment) -> void {
+  upstream_->deallocate(p, bytes, alignment);
+}
+
+#endif
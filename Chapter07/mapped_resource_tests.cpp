@@ -0,0 +1,46 @@
+#include "arena.h"
+#include "mapped_resource.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+
+TEST(MappedResource, SmallMappingsUseNormalPages) {
+  auto resource = MappedResource{};
+  auto* p = resource.allocate(100);
+  std::memset(p, 1, 100);
+  ASSERT_GE(resource.mapped_bytes(), 100);
+  ASSERT_EQ(0, resource.huge_page_bytes());
+  resource.deallocate(p, 100);
+  ASSERT_EQ(0, resource.mapped_bytes());
+}
+
+TEST(MappedResource, LargeMappingsAreAlignedToHugePages) {
+  constexpr auto n = MappedResource::huge_page_size * 3 / 2;
+  auto resource = MappedResource{};
+  auto* p = resource.allocate(n);
+#if MAPPED_RESOURCE_HAS_MMAP
+  ASSERT_EQ(0, reinterpret_cast<std::uintptr_t>(p) %
+                   MappedResource::huge_page_size);
+  ASSERT_EQ(2 * MappedResource::huge_page_size, resource.mapped_bytes());
+#endif
+  std::memset(p, 1, n);
+  resource.deallocate(p, n);
+  ASSERT_EQ(0, resource.mapped_bytes());
+  ASSERT_EQ(0, resource.huge_page_bytes());
+}
+
+TEST(MappedResource, ArenaBlocksComeFromMappings) {
+  auto resource = MappedResource{MappedResource::Options{.populate = false}};
+  {
+    auto arena = Arena<1024>{&resource};
+    auto* p = arena.allocate(4 * 1024 * 1024);
+    std::memset(p, 1, 4 * 1024 * 1024);
+    ASSERT_EQ(2, arena.block_count());
+#if MAPPED_RESOURCE_HAS_MMAP
+    ASSERT_GE(resource.mapped_bytes(), 4 * 1024 * 1024);
+#endif
+  }
+  ASSERT_EQ(0, resource.mapped_bytes());
+}
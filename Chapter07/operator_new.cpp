@@ -1,47 +1,10 @@
 #include <iostream>
+#include <thread>
 #include <gtest/gtest.h>
 
-auto allocated = size_t{0};
-auto print_allocation = bool{false};
-
-void* operator new(size_t isize) {
-  void* p = std::malloc(isize);
-  if (print_allocation) {
-    std::cout << "allocated " << isize << " byte(s)\n";
-  }
-  allocated += isize;
-  return p;
-}
-
-void operator delete(void* p) noexcept {
-  if (print_allocation) {
-    std::cout << "deleted memory\n";
-  }
-  std::free(p);
-}
-
-void operator delete(void* p, std::size_t) noexcept {
-  operator delete(p);
-}
-
-auto operator new[](size_t isize) -> void* {
-  void* p = std::malloc(isize);
-  if (print_allocation) {
-    std::cout << "allocated " << isize << " byte(s) with new[]\n";
-  }
-  return p;
-}
-
-void operator delete[](void* p) noexcept {
-  if (print_allocation) {
-    std::cout << "deleted memory with delete[]\n";
-  }
-  std::free(p);
-}
-
-void operator delete [](void* p, std::size_t) noexcept { 
-  operator delete[](p);
-}
+// The global operator new and delete are replaced in tracked_operator_new.h,
+// which reports all allocations to the allocation tracker
+#include "tracked_operator_new.h"
 
 class Document {
 
@@ -62,11 +25,11 @@ public:
 class OperatorNew : public ::testing::Test {
 protected:
   void SetUp() override {
-    print_allocation = true;
+    alloc_tracker::print_allocations = true;
   }
 
   void TearDown() override {
-    print_allocation = false;
+    alloc_tracker::print_allocations = false;
   }
 };
 
@@ -88,3 +51,57 @@ TEST_F(OperatorNew, AllocateAndDeleteMemory) {
     ::delete p;
   }
 }
+
+// The tests below call operator new and delete directly, the compiler is
+// allowed to remove a new expression whose memory is never used
+TEST(AllocationTracker, TrackAllocations) {
+  auto scope = AllocationScope{};
+  {
+    auto* p = ::operator new[](100);
+    ::operator delete[](p);
+  }
+  {
+    auto* p = new Document{};
+    delete p;
+  }
+  const auto stats = scope.stats();
+  ASSERT_EQ(2, stats.n_allocations);
+  ASSERT_EQ(2, stats.n_deallocations);
+  ASSERT_EQ(100 + sizeof(Document), stats.bytes_allocated);
+  ASSERT_EQ(100, stats.peak_live_bytes);
+  ASSERT_EQ(1, stats.histogram[alloc_tracker::size_class(100)]);
+}
+
+TEST(AllocationTracker, TrackAllocationsFromManyThreads) {
+  auto scope = AllocationScope{};
+  auto allocate = [] {
+    for (int i = 0; i < 1000; ++i) {
+      ::operator delete(::operator new(sizeof(int)));
+    }
+  };
+  auto t1 = std::thread{allocate};
+  auto t2 = std::thread{allocate};
+  t1.join();
+  t2.join();
+  scope.stop();
+  ASSERT_GE(scope.stats().n_allocations, 2000);
+  ASSERT_GE(scope.stats().bytes_allocated, 2000 * sizeof(int));
+}
+
+TEST(AllocationTracker, TrackCallSites) {
+  alloc_tracker::reset_call_sites();
+  alloc_tracker::set_capture_call_sites(true);
+  {
+    auto scope = AllocationScope{};
+    auto* p = ::operator new[](4096);
+    ::operator delete[](p);
+  }
+  alloc_tracker::set_capture_call_sites(false);
+  const auto sites = alloc_tracker::top_call_sites(5);
+  ASSERT_FALSE(sites.empty());
+  ASSERT_EQ(4096, sites.front().bytes);
+  for (const auto& site : sites) {
+    std::cout << site.address << ": " << site.n_allocations
+              << " allocation(s), " << site.bytes << " byte(s)\n";
+  }
+}
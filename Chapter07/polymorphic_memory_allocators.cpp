@@ -3,11 +3,16 @@
 #if defined(__cpp_lib_memory_resource)
 #include <array>
 #include <iostream>
+#include <latch>
 #include <memory_resource>
 #include <set>
+#include <thread>
+#include <vector>
 
 #include <gtest/gtest.h>
 
+#include "arena_resource.h"
+
 // Polymorphic memory allocators is a C++17 feature.
 // It's not supported by Clang libc++ yet.
 
@@ -68,4 +73,45 @@ TEST(PolymorphicMemoryAllocators, CustomMemoryResource) {
   vec.emplace_back(2);
 }
 
+// Using our own Arena as a memory resource
+TEST(PolymorphicMemoryAllocators, ArenaResource) {
+  auto&& arena = Arena<1024>{};
+  auto resource = ArenaResource<1024>{arena};
+  {
+    auto vec = std::pmr::vector<int>{&resource};
+    vec.reserve(16); // The last allocation is rolled back when released
+    ASSERT_EQ(16 * sizeof(int), arena.used());
+  }
+  ASSERT_EQ(0, arena.used());
+
+  auto unique_numbers = std::pmr::set<int>{&resource};
+  for (auto i : {7, 3, 2, 7, 2}) {
+    unique_numbers.insert(i);
+  }
+  ASSERT_EQ(3, unique_numbers.size());
+  ASSERT_EQ(1, arena.block_count());
+}
+
+TEST(PolymorphicMemoryAllocators, ThreadArenaResource) {
+  auto resources = std::array<std::pmr::memory_resource*, 2>{};
+  // Keeps both threads alive until both resources have been recorded, an
+  // exited thread's storage could otherwise be reused by the other one
+  auto both_filled = std::latch{2};
+  auto fill = [&resources, &both_filled](int i) {
+    auto& resource = thread_arena_resource<4096>();
+    auto vec = std::pmr::vector<int>{&resource};
+    for (int j = 0; j < 100; ++j) {
+      vec.push_back(j);
+    }
+    resources[i] = &resource;
+    both_filled.arrive_and_wait();
+  };
+  auto t1 = std::thread{fill, 0};
+  auto t2 = std::thread{fill, 1};
+  t1.join();
+  t2.join();
+  ASSERT_NE(resources[0], resources[1]);
+  ASSERT_EQ(&thread_arena_resource<4096>(), &thread_arena_resource<4096>());
+}
+
 #endif // polymorphic_allocator
@@ -63,3 +63,21 @@ TEST(ShortAlloc, SmallSet) {
       ++unique_number;
   }
 }
+
+TEST(ShortAlloc, SmallSetGrowsIntoArenaBlocks) {
+  using SmallSet = std::set<int, std::less<int>, ShortAlloc<int, 512>>;
+
+  auto&& stack_arena = SmallSet::allocator_type::arena_type{};
+  auto unique_numbers = SmallSet{stack_arena};
+
+  // Far more nodes than fit in 512 bytes, the arena chains extra blocks
+  for (int i = 0; i < 1000; ++i) {
+    unique_numbers.insert(i);
+  }
+  ASSERT_EQ(1000, unique_numbers.size());
+  ASSERT_GT(stack_arena.block_count(), 1);
+
+  stack_arena.for_each_block([](auto u) {
+    std::cout << "block: " << u.used << '/' << u.size << " bytes\n";
+  });
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+
+// A pool of fixed size blocks, divided into size classes of 16 byte steps
+// up to max_block_size. Every size class carves blocks out of slabs
+// allocated from an upstream resource and keeps freed blocks in an
+// intrusive free list, which makes both allocate() and deallocate() O(1).
+// This suits node based containers (std::set, std::map, std::list...)
+// where each node has the same size and nodes are freed in any order.
+// Larger requests are passed on to the upstream resource.
+
+class SlabPool {
+
+  static constexpr size_t alignment = alignof(std::max_align_t);
+
+public:
+  static constexpr size_t max_block_size = 256;
+  static constexpr size_t slab_size = 64 * 1024;
+
+  SlabPool() noexcept : SlabPool(std::pmr::get_default_resource()) {}
+  explicit SlabPool(std::pmr::memory_resource* upstream) noexcept
+      : upstream_{upstream} {}
+  SlabPool(const SlabPool&) = delete;
+  SlabPool& operator=(const SlabPool&) = delete;
+  ~SlabPool() { release(); }
+
+  auto allocate(size_t n) -> std::byte*;
+  auto deallocate(std::byte* p, size_t n) noexcept -> void;
+  auto release() noexcept -> void;
+
+  // Bytes held from upstream, including blocks on the free lists
+  auto resident() const noexcept { return resident_; }
+  // Bytes currently handed out to the users of the pool
+  auto used() const noexcept { return used_; }
+
+private:
+  struct FreeBlock {
+    FreeBlock* next_{};
+  };
+  struct Slab {
+    Slab* next_{};
+    size_t size_{};
+  };
+  struct SizeClass {
+    FreeBlock* free_{};
+    std::byte* ptr_{};
+    std::byte* end_{};
+  };
+  static constexpr size_t n_classes = max_block_size / alignment;
+  static constexpr size_t header_size = (sizeof(Slab) + alignment - 1) &
+                                        ~(alignment - 1);
+
+  static auto align_up(size_t n) noexcept -> size_t {
+    return (n + (alignment - 1)) & ~(alignment - 1);
+  }
+  static auto class_index(size_t aligned_n) noexcept -> size_t {
+    return aligned_n / alignment - 1;
+  }
+  auto refill(SizeClass& c) -> void;
+
+  std::array<SizeClass, n_classes> classes_{};
+  Slab* slabs_{};
+  size_t resident_{};
+  size_t used_{};
+  std::pmr::memory_resource* upstream_{};
+};
+
+inline auto SlabPool::allocate(size_t n) -> std::byte* {
+  const auto aligned_n = align_up(n == 0 ? 1 : n);
+  if (aligned_n > max_block_size) {
+    auto* p = upstream_->allocate(aligned_n, alignment);
+    used_ += aligned_n;
+    resident_ += aligned_n;
+    return static_cast<std::byte*>(p);
+  }
+  auto& c = classes_[class_index(aligned_n)];
+  if (c.free_ != nullptr) {
+    auto* block = c.free_;
+    c.free_ = block->next_;
+    used_ += aligned_n;
+    return reinterpret_cast<std::byte*>(block);
+  }
+  if (static_cast<size_t>(c.end_ - c.ptr_) < aligned_n) {
+    refill(c); // May throw, nothing has been counted yet
+  }
+  auto* r = c.ptr_;
+  c.ptr_ += aligned_n;
+  used_ += aligned_n;
+  return r;
+}
+
+inline auto SlabPool::deallocate(std::byte* p, size_t n) noexcept -> void {
+  const auto aligned_n = align_up(n == 0 ? 1 : n);
+  used_ -= aligned_n;
+  if (aligned_n > max_block_size) {
+    resident_ -= aligned_n;
+    upstream_->deallocate(p, aligned_n, alignment);
+    return;
+  }
+  auto& c = classes_[class_index(aligned_n)];
+  c.free_ = ::new (p) FreeBlock{c.free_};
+}
+
+inline auto SlabPool::refill(SizeClass& c) -> void {
+  // The tail of the previous slab, if any, is left unused. It is smaller
+  // than one block of this size class.
+  auto* mem = upstream_->allocate(header_size + slab_size, alignment);
+  slabs_ = ::new (mem) Slab{slabs_, slab_size};
+  resident_ += header_size + slab_size;
+  c.ptr_ = static_cast<std::byte*>(mem) + header_size;
+  c.end_ = c.ptr_ + slab_size;
+}
+
+// Returns all slabs to upstream. Blocks larger than max_block_size are
+// owned by the user and must be deallocated separately.
+inline auto SlabPool::release() noexcept -> void {
+  for (auto* s = slabs_; s != nullptr;) {
+    auto* next = s->next_;
+    resident_ -= header_size + s->size_;
+    upstream_->deallocate(s, header_size + s->size_, alignment);
+    s = next;
+  }
+  slabs_ = nullptr;
+  classes_ = {};
+  used_ = resident_; // Only the large blocks are left
+}
+
+// Standard allocator drawing memory from a SlabPool
+template <class T>
+struct PoolAlloc {
+  using value_type = T;
+  PoolAlloc(const PoolAlloc&) = default;
+  PoolAlloc& operator=(const PoolAlloc&) = default;
+  PoolAlloc(SlabPool& pool) noexcept : pool_{&pool} {}
+  template <class U>
+  PoolAlloc(const PoolAlloc<U>& other) noexcept : pool_{other.pool_} {}
+  auto allocate(size_t n) -> T* {
+    return reinterpret_cast<T*>(pool_->allocate(n * sizeof(T)));
+  }
+  auto deallocate(T* p, size_t n) noexcept -> void {
+    pool_->deallocate(reinterpret_cast<std::byte*>(p), n * sizeof(T));
+  }
+  template <class U>
+  auto operator==(const PoolAlloc<U>& other) const noexcept {
+    return pool_ == other.pool_;
+  }
+  template <class U>
+  auto operator!=(const PoolAlloc<U>& other) const noexcept {
+    return !(*this == other);
+  }
+  template <class U> friend struct PoolAlloc;
+
+private:
+  SlabPool* pool_;
+};
@@ -0,0 +1,91 @@
+#include "slab_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <forward_list>
+#include <list>
+#include <map>
+#include <memory_resource>
+#include <new>
+#include <set>
+#include <string>
+
+TEST(SlabPool, ReusesFreedBlocks) {
+  auto pool = SlabPool{};
+  auto* p1 = pool.allocate(40);
+  auto* p2 = pool.allocate(40);
+  pool.deallocate(p1, 40);
+  ASSERT_EQ(p1, pool.allocate(40)); // Served from the free list
+  pool.deallocate(p2, 40);
+  ASSERT_EQ(48, pool.used());
+  ASSERT_EQ(1, pool.resident() / SlabPool::slab_size);
+}
+
+TEST(SlabPool, SizeClassesDoNotShareBlocks) {
+  auto pool = SlabPool{};
+  auto* small = pool.allocate(16);
+  pool.deallocate(small, 16);
+  auto* large = pool.allocate(64);
+  ASSERT_NE(small, large);
+  pool.deallocate(large, 64);
+}
+
+TEST(SlabPool, FailedRefillIsNotCounted) {
+  auto pool = SlabPool{std::pmr::null_memory_resource()};
+  ASSERT_THROW(pool.allocate(40), std::bad_alloc);
+  ASSERT_THROW(pool.allocate(1000), std::bad_alloc);
+  ASSERT_EQ(0, pool.used());
+  ASSERT_EQ(0, pool.resident());
+}
+
+TEST(SlabPool, LargeBlocksGoUpstream) {
+  auto pool = SlabPool{};
+  auto* p = pool.allocate(1000);
+  ASSERT_EQ(1008, pool.used());
+  ASSERT_EQ(1008, pool.resident());
+  pool.deallocate(p, 1000);
+  ASSERT_EQ(0, pool.used());
+  ASSERT_EQ(0, pool.resident());
+}
+
+TEST(SlabPool, SetChurnKeepsMemoryBounded) {
+  using PoolSet = std::set<int, std::less<int>, PoolAlloc<int>>;
+  auto pool = SlabPool{};
+  auto numbers = PoolSet{pool};
+  for (int round = 0; round < 100; ++round) {
+    for (int i = 0; i < 1000; ++i) {
+      numbers.insert(round * 1000 + i);
+    }
+    const auto resident = pool.resident();
+    numbers.clear();
+    ASSERT_EQ(0, pool.used());
+    ASSERT_EQ(resident, pool.resident());
+  }
+  ASSERT_EQ(1, pool.resident() / SlabPool::slab_size);
+}
+
+TEST(SlabPool, NodeBasedContainers) {
+  auto pool = SlabPool{};
+  {
+    using Map = std::map<int, std::string, std::less<int>,
+                         PoolAlloc<std::pair<const int, std::string>>>;
+    auto map = Map{pool};
+    map[1] = "one";
+    map[2] = "two";
+    map.erase(1);
+    ASSERT_EQ("two", map.at(2));
+
+    auto list = std::list<int, PoolAlloc<int>>{pool};
+    list.push_back(1);
+    list.push_front(0);
+    list.pop_back();
+    ASSERT_EQ(0, list.front());
+
+    auto flist = std::forward_list<int, PoolAlloc<int>>{pool};
+    flist.push_front(1);
+    flist.push_front(2);
+    flist.pop_front();
+    ASSERT_EQ(1, flist.front());
+  }
+  ASSERT_EQ(0, pool.used());
+}
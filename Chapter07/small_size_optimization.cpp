@@ -1,22 +1,35 @@
 #include <iostream>
+#include <optional>
+#include <string>
 #include <gtest/gtest.h>
 
-// See operator new() and operator delete() implementation in operator_new.cpp file
-extern size_t allocated;
+// The global operator new() is replaced in operator_new.cpp and reports all
+// allocations to the allocation tracker
+#include "alloc_tracker.h"
+#include "small_string.h"
+#include "small_vector.h"
 
 auto print_string_mem(const char* chars) {
-  allocated = 0;
+  auto scope = AllocationScope{};
   auto s = std::string(chars);
+  scope.stop();
   std::cout << "stack space = " << sizeof(s)
-    << ", heap space = " << allocated
+    << ", heap space = " << scope.stats().bytes_allocated
     << ", capacity = " << s.capacity() << '\n';
 }
 
 class SmallSizeOptimization : public ::testing::Test {
 protected:
   void SetUp() override {
-    allocated = 0;
+    scope_.emplace();
   }
+  void TearDown() override {
+    scope_->stop();
+    std::cout << "allocations during test = " << scope_->stats().n_allocations
+      << '\n';
+    scope_.reset();
+  }
+  std::optional<AllocationScope> scope_{};
 };
 
 TEST_F(SmallSizeOptimization, StringMemory) {
@@ -31,3 +44,83 @@ TEST_F(SmallSizeOptimization, StringMemory) {
   print_string_mem("12345678901234567890123");
 #endif
 }
+
+// Our own small size optimized types with configurable inline capacity
+
+TEST_F(SmallSizeOptimization, SmallStringStaysInline) {
+  auto scope = AllocationScope{};
+  auto s = SmallString<31>{"0123456789012345678901234567890"}; // 31 chars
+  auto copy = s;
+  auto moved = std::move(copy);
+  ASSERT_TRUE(s.is_inline());
+  ASSERT_EQ(31, s.size());
+  ASSERT_EQ(s, moved);
+  ASSERT_EQ('\0', *s.end());
+  ASSERT_EQ(0, scope.stats().n_allocations);
+
+  s.push_back('x'); // One too many
+  ASSERT_FALSE(s.is_inline());
+  ASSERT_EQ(1, scope.stats().n_allocations);
+  ASSERT_EQ("0123456789012345678901234567890x", std::string_view{s});
+}
+
+TEST_F(SmallSizeOptimization, MovedFromSmallStringIsEmpty) {
+  auto s = SmallString<4>{"abc"};
+  auto heap = SmallString<4>{"abcdefgh"};
+  auto moved = std::move(s);
+  auto moved_heap = SmallString<4>{};
+  moved_heap = std::move(heap);
+  for (auto* from : {&s, &heap}) {
+    ASSERT_TRUE(from->empty());
+    ASSERT_TRUE(from->is_inline());
+    ASSERT_STREQ("", from->c_str());
+    from->push_back('x');
+    ASSERT_EQ("x", *from);
+  }
+  ASSERT_EQ("abc", moved);
+  ASSERT_EQ("abcdefgh", moved_heap);
+}
+
+TEST_F(SmallSizeOptimization, SmallStringAppend) {
+  auto s = SmallString<8>{"abc"};
+  s += "def";
+  s.append("gh");
+  ASSERT_EQ("abcdefgh", s);
+  ASSERT_TRUE(s.is_inline());
+  s += "i";
+  ASSERT_EQ("abcdefghi", s);
+  ASSERT_STREQ("abcdefghi", s.c_str());
+  ASSERT_LT(s, "abd");
+}
+
+TEST_F(SmallSizeOptimization, SmallVectorStaysInline) {
+  auto scope = AllocationScope{};
+  auto v = SmallVector<int, 4>{1, 2, 3};
+  v.push_back(4);
+  auto copy = v;
+  auto moved = std::move(copy);
+  ASSERT_TRUE(v.is_inline());
+  ASSERT_EQ(v, moved);
+  ASSERT_EQ(0, scope.stats().n_allocations);
+
+  v.push_back(5);
+  ASSERT_FALSE(v.is_inline());
+  ASSERT_EQ(1, scope.stats().n_allocations);
+  ASSERT_EQ(5, v.back());
+}
+
+TEST_F(SmallSizeOptimization, SmallVectorMoveStealsHeapBuffer) {
+  auto v = SmallVector<std::string, 2>{"a", "b", "c"};
+  auto scope = AllocationScope{};
+  auto* data = v.data();
+  auto moved = std::move(v);
+  ASSERT_EQ(data, moved.data());
+  ASSERT_TRUE(v.empty());
+  ASSERT_TRUE(v.is_inline());
+  ASSERT_EQ(0, scope.stats().n_allocations);
+
+  v.push_back(moved[0]); // Reuse of a moved from vector
+  ASSERT_EQ("a", v[0]);
+  moved.resize(1);
+  ASSERT_EQ(1, moved.size());
+}
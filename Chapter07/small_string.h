@@ -0,0 +1,92 @@
+#pragma once
+
+#include "small_vector.h"
+
+#include <compare>
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <string_view>
+
+// A string storing up to N characters inside the object itself, unlike
+// std::string where the inline capacity is fixed by the library (15 or 22
+// characters depending on the implementation). The characters are kept in
+// a SmallVector together with a terminating null character.
+
+template <size_t N>
+class SmallString {
+public:
+  SmallString() { chars_.push_back('\0'); }
+  SmallString(std::string_view s) { assign(s); }
+  SmallString(const char* s) : SmallString(std::string_view{s}) {}
+  SmallString(const SmallString&) = default;
+  auto operator=(const SmallString&) -> SmallString& = default;
+  // The moved-from string is left empty, with its null character back in
+  // the inline buffer, which can't allocate
+  SmallString(SmallString&& other) noexcept
+      : chars_{std::move(other.chars_)} {
+    other.chars_.push_back('\0');
+  }
+  auto operator=(SmallString&& other) noexcept -> SmallString& {
+    if (this != &other) {
+      chars_ = std::move(other.chars_);
+      other.chars_.push_back('\0');
+    }
+    return *this;
+  }
+
+  static constexpr auto inline_capacity() noexcept { return N; }
+  auto is_inline() const noexcept { return chars_.is_inline(); }
+  auto size() const noexcept { return chars_.size() - 1; }
+  auto capacity() const noexcept { return chars_.capacity() - 1; }
+  auto empty() const noexcept { return size() == 0; }
+  auto data() const noexcept { return chars_.data(); }
+  auto c_str() const noexcept { return chars_.data(); }
+  auto begin() const noexcept { return chars_.begin(); }
+  auto end() const noexcept { return chars_.end() - 1; }
+  auto operator[](size_t i) const noexcept { return chars_[i]; }
+  operator std::string_view() const noexcept { return {data(), size()}; }
+
+  auto assign(std::string_view s) -> SmallString& {
+    chars_.clear();
+    chars_.reserve(s.size() + 1);
+    chars_.append(s.begin(), s.end());
+    chars_.push_back('\0');
+    return *this;
+  }
+  auto append(std::string_view s) -> SmallString& {
+    chars_.pop_back();
+    chars_.append(s.begin(), s.end());
+    chars_.push_back('\0');
+    return *this;
+  }
+  void push_back(char c) {
+    chars_.back() = c;
+    chars_.push_back('\0');
+  }
+  auto operator+=(std::string_view s) -> SmallString& { return append(s); }
+  void clear() noexcept {
+    chars_.clear();
+    chars_.push_back('\0');
+  }
+
+  friend auto operator==(const SmallString& a, std::string_view b) noexcept {
+    return std::string_view{a} == b;
+  }
+  friend auto operator<=>(const SmallString& a, std::string_view b) noexcept {
+    return std::string_view{a} <=> b;
+  }
+  friend auto& operator<<(std::ostream& os, const SmallString& s) {
+    return os << std::string_view{s};
+  }
+
+private:
+  SmallVector<char, N + 1> chars_{};
+};
+
+template <size_t N>
+struct std::hash<SmallString<N>> {
+  auto operator()(const SmallString<N>& s) const noexcept {
+    return std::hash<std::string_view>{}(s);
+  }
+};
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// A vector storing up to N elements inside the object itself. Only when the
+// size grows beyond N are the elements moved to the free store, which means
+// that short vectors never allocate any memory.
+
+template <typename T, size_t N>
+class SmallVector {
+  static_assert(N > 0);
+
+public:
+  using value_type = T;
+  using size_type = size_t;
+  using iterator = T*;
+  using const_iterator = const T*;
+
+  SmallVector() noexcept = default;
+  SmallVector(std::initializer_list<T> init) {
+    reserve(init.size());
+    std::uninitialized_copy(init.begin(), init.end(), data_);
+    size_ = init.size();
+  }
+  SmallVector(const SmallVector& other) {
+    reserve(other.size_);
+    std::uninitialized_copy(other.begin(), other.end(), data_);
+    size_ = other.size_;
+  }
+  SmallVector(SmallVector&& other) noexcept(
+      std::is_nothrow_move_constructible_v<T>) {
+    steal(other);
+  }
+  auto operator=(const SmallVector& other) -> SmallVector& {
+    if (this != &other) {
+      clear();
+      reserve(other.size_);
+      std::uninitialized_copy(other.begin(), other.end(), data_);
+      size_ = other.size_;
+    }
+    return *this;
+  }
+  auto operator=(SmallVector&& other) noexcept(
+      std::is_nothrow_move_constructible_v<T>) -> SmallVector& {
+    if (this != &other) {
+      clear();
+      deallocate();
+      steal(other);
+    }
+    return *this;
+  }
+  ~SmallVector() {
+    clear();
+    deallocate();
+  }
+
+  static constexpr auto inline_capacity() noexcept { return N; }
+  auto is_inline() const noexcept { return data_ == inline_data(); }
+  auto size() const noexcept { return size_; }
+  auto capacity() const noexcept { return capacity_; }
+  auto empty() const noexcept { return size_ == 0; }
+  auto data() noexcept { return data_; }
+  auto data() const noexcept -> const T* { return data_; }
+  auto begin() noexcept { return data_; }
+  auto end() noexcept { return data_ + size_; }
+  auto begin() const noexcept -> const T* { return data_; }
+  auto end() const noexcept -> const T* { return data_ + size_; }
+  auto& operator[](size_t i) noexcept { return data_[i]; }
+  auto& operator[](size_t i) const noexcept { return data_[i]; }
+  auto& front() noexcept { return data_[0]; }
+  auto& back() noexcept { return data_[size_ - 1]; }
+
+  void reserve(size_t n);
+  template <typename... Args> auto& emplace_back(Args&&... args);
+  template <typename It> void append(It first, It last);
+  void push_back(const T& v) { emplace_back(v); }
+  void push_back(T&& v) { emplace_back(std::move(v)); }
+  void pop_back() noexcept {
+    assert(size_ > 0);
+    std::destroy_at(data_ + --size_);
+  }
+  void clear() noexcept {
+    std::destroy(begin(), end());
+    size_ = 0;
+  }
+  void resize(size_t n) {
+    reserve(n);
+    if (n > size_) {
+      std::uninitialized_value_construct(data_ + size_, data_ + n);
+    } else {
+      std::destroy(data_ + n, data_ + size_);
+    }
+    size_ = n;
+  }
+
+  friend auto operator==(const SmallVector& a, const SmallVector& b) {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end());
+  }
+
+private:
+  auto inline_data() noexcept { return reinterpret_cast<T*>(buffer_); }
+  auto inline_data() const noexcept {
+    return reinterpret_cast<const T*>(buffer_);
+  }
+  void deallocate() noexcept {
+    if (!is_inline()) {
+      std::allocator<T>{}.deallocate(data_, capacity_);
+      data_ = inline_data();
+      capacity_ = N;
+    }
+  }
+  // Takes over the elements of other, which is left empty. A heap buffer
+  // is taken as is, inline elements are moved one by one.
+  void steal(SmallVector& other) {
+    if (other.is_inline()) {
+      if constexpr (std::is_trivially_copyable_v<T>) {
+        std::memcpy(buffer_, other.buffer_, sizeof(buffer_)); // Fixed size
+      } else {
+        std::uninitialized_move(other.begin(), other.end(), data_);
+      }
+      size_ = other.size_;
+      other.clear();
+    } else {
+      data_ = std::exchange(other.data_, other.inline_data());
+      size_ = std::exchange(other.size_, 0);
+      capacity_ = std::exchange(other.capacity_, N);
+    }
+  }
+
+  alignas(T) std::byte buffer_[N * sizeof(T)];
+  T* data_{inline_data()};
+  size_t size_{0};
+  size_t capacity_{N};
+};
+
+template <typename T, size_t N>
+void SmallVector<T, N>::reserve(size_t n) {
+  if (n <= capacity_) {
+    return;
+  }
+  const auto new_capacity = std::max(n, capacity_ * 2);
+  auto* new_data = std::allocator<T>{}.allocate(new_capacity);
+  try {
+    if constexpr (std::is_nothrow_move_constructible_v<T> ||
+                  !std::is_copy_constructible_v<T>) {
+      std::uninitialized_move(begin(), end(), new_data);
+    } else {
+      std::uninitialized_copy(begin(), end(), new_data);
+    }
+  } catch (...) {
+    std::allocator<T>{}.deallocate(new_data, new_capacity);
+    throw;
+  }
+  std::destroy(begin(), end());
+  deallocate();
+  data_ = new_data;
+  capacity_ = new_capacity;
+}
+
+template <typename T, size_t N>
+template <typename... Args>
+auto& SmallVector<T, N>::emplace_back(Args&&... args) {
+  if (size_ == capacity_) {
+    // Construct the new element first, args might refer to an element
+    auto tmp = T(std::forward<Args>(args)...);
+    reserve(size_ + 1);
+    std::construct_at(data_ + size_, std::move(tmp));
+  } else {
+    std::construct_at(data_ + size_, std::forward<Args>(args)...);
+  }
+  return data_[size_++];
+}
+
+template <typename T, size_t N>
+template <typename It>
+void SmallVector<T, N>::append(It first, It last) {
+  const auto n = static_cast<size_t>(std::distance(first, last));
+  reserve(size_ + n);
+  std::uninitialized_copy(first, last, data_ + size_);
+  size_ += n;
+}
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <ostream>
+#include <source_location>
+#include <span>
+
+// A stack-first memory resource. Memory is handed out from a buffer owned
+// by the caller, typically on the stack, and requests which do not fit go
+// to an upstream resource. Since the buffer size is not part of the type,
+// a std::pmr::set<int> using a 512 byte buffer is the same type as one
+// using a 1024 byte buffer, unlike with ShortAlloc<T, N>.
+//
+// A resource can be tied to an OverflowSite, which collects how often and
+// by how much the buffer of that call site was too small. The statistics
+// are meant to be dumped in production and used to pick buffer sizes.
+
+// Statistics of all resources created at one call site
+struct OverflowStats {
+  const char* name{};
+  const char* file{};
+  std::uint_least32_t line{};
+  size_t buffer_size{};       // The largest buffer used at the site
+  size_t n_uses{};            // Number of destroyed resources
+  size_t n_overflows{};       // Resources which needed upstream memory
+  size_t n_upstream_allocs{}; // Allocations passed on to upstream
+  size_t overflow_bytes{};    // Bytes allocated from upstream
+  size_t peak_bytes{};        // The most memory ever in use at once
+};
+
+// Declared as a static at the call site, for example:
+//   static auto site = OverflowSite{"parse_header"};
+// All sites are registered in a global list when first constructed.
+class OverflowSite {
+public:
+  explicit OverflowSite(
+      const char* name = "",
+      std::source_location location = std::source_location::current()) noexcept
+      : name_{name}, location_{location} {
+    next_ = head().load();
+    while (!head().compare_exchange_weak(next_, this)) {
+    }
+  }
+  OverflowSite(const OverflowSite&) = delete;
+  OverflowSite& operator=(const OverflowSite&) = delete;
+
+  auto stats() const noexcept -> OverflowStats {
+    const auto relaxed = std::memory_order_relaxed;
+    return {name_,
+            location_.file_name(),
+            location_.line(),
+            buffer_size_.load(relaxed),
+            n_uses_.load(relaxed),
+            n_overflows_.load(relaxed),
+            n_upstream_allocs_.load(relaxed),
+            overflow_bytes_.load(relaxed),
+            peak_bytes_.load(relaxed)};
+  }
+  auto reset() noexcept -> void {
+    for (auto* counter : {&buffer_size_, &n_uses_, &n_overflows_,
+                          &n_upstream_allocs_, &overflow_bytes_,
+                          &peak_bytes_}) {
+      counter->store(0, std::memory_order_relaxed);
+    }
+  }
+
+  // Called by a StackResource when it is destroyed
+  auto record(size_t buffer_size, size_t n_upstream_allocs,
+              size_t overflow_bytes, size_t peak_bytes) noexcept -> void {
+    const auto relaxed = std::memory_order_relaxed;
+    update_max(buffer_size_, buffer_size);
+    n_uses_.fetch_add(1, relaxed);
+    if (n_upstream_allocs > 0) {
+      n_overflows_.fetch_add(1, relaxed);
+      n_upstream_allocs_.fetch_add(n_upstream_allocs, relaxed);
+      overflow_bytes_.fetch_add(overflow_bytes, relaxed);
+    }
+    update_max(peak_bytes_, peak_bytes);
+  }
+
+  template <typename F>
+  static auto for_each(F f) -> void {
+    for (const auto* s = head().load(); s != nullptr; s = s->next_) {
+      f(s->stats());
+    }
+  }
+
+private:
+  static auto head() noexcept -> std::atomic<const OverflowSite*>& {
+    static auto sites = std::atomic<const OverflowSite*>{nullptr};
+    return sites;
+  }
+  static auto update_max(std::atomic<size_t>& a, size_t v) noexcept -> void {
+    auto current = a.load(std::memory_order_relaxed);
+    while (v > current && !a.compare_exchange_weak(current, v,
+                                                   std::memory_order_relaxed)) {
+    }
+  }
+
+  const char* name_{};
+  std::source_location location_{};
+  const OverflowSite* next_{};
+  std::atomic<size_t> buffer_size_{};
+  std::atomic<size_t> n_uses_{};
+  std::atomic<size_t> n_overflows_{};
+  std::atomic<size_t> n_upstream_allocs_{};
+  std::atomic<size_t> overflow_bytes_{};
+  std::atomic<size_t> peak_bytes_{};
+};
+
+// One line per call site, for example:
+//   parser.cpp:42 parse_header buffer: 512 uses: 1000 overflows: 12 ...
+inline auto print_overflow_sites(std::ostream& os) -> void {
+  OverflowSite::for_each([&os](const OverflowStats& s) {
+    os << s.file << ':' << s.line << ' ' << s.name
+       << " buffer: " << s.buffer_size << " uses: " << s.n_uses
+       << " overflows: " << s.n_overflows
+       << " upstream allocs: " << s.n_upstream_allocs
+       << " overflow bytes: " << s.overflow_bytes
+       << " peak bytes: " << s.peak_bytes << '\n';
+  });
+}
+
+// Buffer for a StackResource, the size only appears here
+template <size_t N>
+struct StackBuffer {
+  alignas(std::max_align_t) std::byte data_[N];
+  operator std::span<std::byte>() noexcept { return data_; }
+};
+
+class StackResource : public std::pmr::memory_resource {
+public:
+  explicit StackResource(
+      std::span<std::byte> buffer, OverflowSite* site = nullptr,
+      std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+      : buffer_{buffer}, site_{site}, upstream_{upstream} {}
+  StackResource(const StackResource&) = delete;
+  StackResource& operator=(const StackResource&) = delete;
+  ~StackResource() {
+    if (site_ != nullptr) {
+      site_->record(buffer_.size(), n_upstream_allocs_, overflow_bytes_,
+                    peak_bytes_);
+    }
+  }
+
+  auto buffer_size() const noexcept { return buffer_.size(); }
+  auto used() const noexcept { return used_; }
+  auto n_upstream_allocs() const noexcept { return n_upstream_allocs_; }
+  auto overflow_bytes() const noexcept { return overflow_bytes_; }
+  // The most memory in use at once, the buffer size needed to not overflow
+  auto peak_bytes() const noexcept { return peak_bytes_; }
+
+private:
+  auto do_allocate(size_t bytes, size_t alignment) -> void* override {
+    const auto begin = reinterpret_cast<std::uintptr_t>(buffer_.data());
+    const auto aligned = (begin + used_ + alignment - 1) & ~(alignment - 1);
+    const auto offset = static_cast<size_t>(aligned - begin);
+    if (offset + bytes <= buffer_.size()) {
+      used_ = offset + bytes;
+      peak_bytes_ = std::max(peak_bytes_, used_ + live_upstream_bytes_);
+      return buffer_.data() + offset;
+    }
+    auto* p = upstream_->allocate(bytes, alignment);
+    ++n_upstream_allocs_;
+    overflow_bytes_ += bytes;
+    live_upstream_bytes_ += bytes;
+    peak_bytes_ = std::max(peak_bytes_, used_ + live_upstream_bytes_);
+    return p;
+  }
+
+  auto do_deallocate(void* p, size_t bytes, size_t alignment)
+      -> void override {
+    auto* b = static_cast<std::byte*>(p);
+    const auto address = reinterpret_cast<std::uintptr_t>(b);
+    const auto begin = reinterpret_cast<std::uintptr_t>(buffer_.data());
+    if (begin <= address && address < begin + buffer_.size()) {
+      // Only the most recent allocation is reclaimed
+      if (b + bytes == buffer_.data() + used_) {
+        used_ = static_cast<size_t>(b - buffer_.data());
+      }
+      return;
+    }
+    live_upstream_bytes_ -= bytes;
+    upstream_->deallocate(p, bytes, alignment);
+  }
+
+  auto do_is_equal(const std::pmr::memory_resource& other) const noexcept
+      -> bool override {
+    return this == &other;
+  }
+
+  std::span<std::byte> buffer_{};
+  OverflowSite* site_{};
+  std::pmr::memory_resource* upstream_{};
+  size_t used_{};
+  size_t live_upstream_bytes_{};
+  size_t n_upstream_allocs_{};
+  size_t overflow_bytes_{};
+  size_t peak_bytes_{};
+};
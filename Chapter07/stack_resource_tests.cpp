@@ -0,0 +1,72 @@
+#include "stack_resource.h"
+
+#include <gtest/gtest.h>
+
+#include <memory_resource>
+#include <set>
+#include <sstream>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+auto fill(std::pmr::set<int>& s, int n) {
+  for (int i = 0; i < n; ++i) {
+    s.insert(i);
+  }
+}
+
+} // namespace
+
+TEST(StackResource, BufferSizeIsNotPartOfTheType) {
+  auto small_buffer = StackBuffer<512>{};
+  auto large_buffer = StackBuffer<1024>{};
+  auto small_resource = StackResource{small_buffer};
+  auto large_resource = StackResource{large_buffer};
+  auto a = std::pmr::set<int>{&small_resource};
+  auto b = std::pmr::set<int>{&large_resource};
+  static_assert(std::is_same_v<decltype(a), decltype(b)>);
+  fill(a, 5);
+  fill(b, 5);
+  ASSERT_EQ(0, small_resource.n_upstream_allocs());
+  ASSERT_EQ(0, large_resource.n_upstream_allocs());
+}
+
+TEST(StackResource, OverflowGoesUpstream) {
+  auto buffer = StackBuffer<256>{};
+  auto resource = StackResource{buffer};
+  auto v = std::pmr::vector<int>{&resource};
+  v.reserve(32); // 128 bytes, fits
+  ASSERT_EQ(0, resource.n_upstream_allocs());
+  v.reserve(64); // 256 bytes, does not fit after the first 128 bytes
+  ASSERT_EQ(1, resource.n_upstream_allocs());
+  ASSERT_EQ(256, resource.overflow_bytes());
+  ASSERT_EQ(128 + 256, resource.peak_bytes());
+}
+
+TEST(StackResource, RecordsOverflowPerCallSite) {
+  static auto site = OverflowSite{"test_site"};
+  site.reset();
+  for (int n : {10, 20, 1000}) {
+    auto buffer = StackBuffer<1024>{};
+    auto resource = StackResource{buffer, &site};
+    auto s = std::pmr::set<int>{&resource};
+    fill(s, n);
+  }
+  const auto stats = site.stats();
+  ASSERT_EQ(1024, stats.buffer_size);
+  ASSERT_EQ(3, stats.n_uses);
+  ASSERT_EQ(1, stats.n_overflows);
+  ASSERT_GT(stats.n_upstream_allocs, 0);
+  ASSERT_GT(stats.peak_bytes, 1024);
+
+  auto found = false;
+  OverflowSite::for_each([&found](const OverflowStats& s) {
+    found = found || std::string_view{s.name} == "test_site";
+  });
+  ASSERT_TRUE(found);
+
+  auto os = std::ostringstream{};
+  print_overflow_sites(os);
+  ASSERT_NE(std::string::npos, os.str().find("test_site"));
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+// Replaces the global operator new and delete with versions reporting to the
+// allocation tracker. Include this file in exactly one source file of an
+// executable. Every allocation is prefixed with a header holding its size,
+// since the unsized operator delete does not know the size of the memory.
+
+#include "alloc_tracker.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define ALLOC_TRACKER_CALLER _ReturnAddress()
+#elif defined(__GNUC__)
+#define ALLOC_TRACKER_CALLER __builtin_return_address(0)
+#else
+#define ALLOC_TRACKER_CALLER nullptr
+#endif
+
+namespace alloc_tracker {
+
+// Prints every allocation and deallocation to stdout
+inline std::atomic<bool> print_allocations{false};
+
+namespace detail {
+
+constexpr auto header_size = alignof(std::max_align_t);
+
+inline auto tracked_new(size_t n, const void* site, const char* kind)
+    -> void* {
+  auto* p = static_cast<std::byte*>(std::malloc(n + header_size));
+  if (p == nullptr) {
+    throw std::bad_alloc{};
+  }
+  *reinterpret_cast<size_t*>(p) = n;
+  if (print_allocations.load(std::memory_order_relaxed)) {
+    std::printf("allocated %zu byte(s)%s\n", n, kind);
+  }
+  record_allocation(n, site);
+  return p + header_size;
+}
+
+inline auto tracked_delete(void* p, const char* kind) noexcept {
+  if (p == nullptr) {
+    return;
+  }
+  auto* header = static_cast<std::byte*>(p) - header_size;
+  if (print_allocations.load(std::memory_order_relaxed)) {
+    std::printf("deleted memory%s\n", kind);
+  }
+  record_deallocation(*reinterpret_cast<size_t*>(header));
+  std::free(header);
+}
+
+// Over-aligned allocations store the size and the pointer returned by
+// malloc() in the two words preceding the aligned memory
+inline auto tracked_aligned_new(size_t n, std::align_val_t al,
+                                const void* site) -> void* {
+  const auto alignment = static_cast<size_t>(al);
+  constexpr auto prefix = 2 * sizeof(void*);
+  auto* raw = static_cast<std::byte*>(std::malloc(n + alignment + prefix));
+  if (raw == nullptr) {
+    throw std::bad_alloc{};
+  }
+  const auto address = reinterpret_cast<std::uintptr_t>(raw) + prefix;
+  auto* p = reinterpret_cast<std::byte*>((address + alignment - 1) &
+                                         ~(alignment - 1));
+  reinterpret_cast<void**>(p)[-1] = raw;
+  reinterpret_cast<size_t*>(p)[-2] = n;
+  record_allocation(n, site);
+  return p;
+}
+
+inline auto tracked_aligned_delete(void* p) noexcept {
+  if (p == nullptr) {
+    return;
+  }
+  record_deallocation(static_cast<size_t*>(p)[-2]);
+  std::free(static_cast<void**>(p)[-1]);
+}
+
+} // namespace detail
+} // namespace alloc_tracker
+
+void* operator new(size_t n) {
+  return alloc_tracker::detail::tracked_new(n, ALLOC_TRACKER_CALLER, "");
+}
+
+void operator delete(void* p) noexcept {
+  alloc_tracker::detail::tracked_delete(p, "");
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+  alloc_tracker::detail::tracked_delete(p, "");
+}
+
+void* operator new[](size_t n) {
+  return alloc_tracker::detail::tracked_new(n, ALLOC_TRACKER_CALLER,
+                                            " with new[]");
+}
+
+void operator delete[](void* p) noexcept {
+  alloc_tracker::detail::tracked_delete(p, " with delete[]");
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+  alloc_tracker::detail::tracked_delete(p, " with delete[]");
+}
+
+void* operator new(size_t n, std::align_val_t al) {
+  return alloc_tracker::detail::tracked_aligned_new(n, al,
+                                                    ALLOC_TRACKER_CALLER);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+  alloc_tracker::detail::tracked_aligned_delete(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+  alloc_tracker::detail::tracked_aligned_delete(p);
+}
+
+void* operator new[](size_t n, std::align_val_t al) {
+  return alloc_tracker::detail::tracked_aligned_new(n, al,
+                                                    ALLOC_TRACKER_CALLER);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept {
+  alloc_tracker::detail::tracked_aligned_delete(p);
+}
+
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept {
+  alloc_tracker::detail::tracked_aligned_delete(p);
+}
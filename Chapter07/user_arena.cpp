@@ -1,6 +1,9 @@
 #include <gtest/gtest.h>
 #include "arena.h"
+#include "concurrent_arena.h"
 #include <memory>
+#include <thread>
+#include <vector>
 
 auto&& user_arena = Arena<1024>{}; // [auto&& is needed in current version of MSVC]
 
@@ -35,3 +38,40 @@ TEST(UserArena, UsingTheArena) {
   auto user2 = std::make_unique<User>();
 
 }
+
+// Arena<N> is not thread safe, use a ConcurrentArena if the objects are
+// created from multiple threads
+auto&& concurrent_user_arena = ConcurrentArena<64 * 1024>{};
+
+class ConcurrentUser {
+public:
+  auto operator new(size_t size) -> void* {
+    return concurrent_user_arena.allocate(size);
+  }
+  auto operator delete(void* p) -> void {
+    concurrent_user_arena.deallocate(static_cast<std::byte*>(p),
+                                     sizeof(ConcurrentUser));
+  }
+
+private:
+  int id_{};
+};
+
+TEST(UserArena, UsingTheConcurrentArena) {
+  auto create_users = [] {
+    for (int i = 0; i < 1000; ++i) {
+      auto user = std::make_unique<ConcurrentUser>();
+    }
+  };
+  auto threads = std::vector<std::thread>{};
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back(create_users);
+  }
+  for (auto&& t : threads) {
+    t.join();
+  }
+  // Each user is deallocated before the next is created, which rolls back
+  // the magazine of each thread
+  ASSERT_LE(concurrent_user_arena.used(),
+            4 * concurrent_user_arena.magazine_size);
+}
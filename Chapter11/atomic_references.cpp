@@ -5,7 +5,10 @@
 
 #include <gtest/gtest.h>
 
+#include "per_thread.h"
+
 #include <atomic>
+#include <functional>
 #include <iostream>
 #include <random>
 #include <thread>
@@ -43,6 +46,24 @@ void flip_coin(std::size_t n, Stats& outcomes) {
   auto t2 = std::jthread{flip, n - (n / 2)}; // The rest
 }
 
+// Each thread flips into its own padded Stats, which are merged after the
+// threads are joined. No atomics are needed.
+void flip_coin_per_thread(std::size_t n, Stats& outcomes) {
+  auto local = PerThread<Stats>{2};
+  auto flip = [](auto n, Stats& s) {
+    for (auto i = 0u; i < n; ++i) {
+      random_int(0, 1) == 0 ? ++s.heads : ++s.tails;
+    }
+  };
+  {
+    auto t1 = std::jthread{flip, n / 2, std::ref(local[0])};
+    auto t2 = std::jthread{flip, n - (n / 2), std::ref(local[1])};
+  }
+  outcomes = local.combine(outcomes, [](Stats a, const Stats& b) {
+    return Stats{a.heads + b.heads, a.tails + b.tails};
+  });
+}
+
 TEST(Atomics, AtomicReferences) {
   auto stats = Stats{};
   flip_coin(5000, stats); // Flip 5000 times
@@ -50,6 +71,12 @@ TEST(Atomics, AtomicReferences) {
   ASSERT_EQ(5000, (stats.tails + stats.heads));
 }
 
+TEST(Atomics, PerThreadStats) {
+  auto stats = Stats{};
+  flip_coin_per_thread(5000, stats);
+  ASSERT_EQ(5000, (stats.tails + stats.heads));
+}
+
 } // namespace
 
 #endif // atomic ref && jthread
\ No newline at end of file
@@ -0,0 +1,84 @@
+#include "../bounded_buffer.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+//
+// Many producers and consumers passing std::string payloads through the
+// BoundedBuffer from semaphores.cpp, which locks a mutex on top of the two
+// semaphore operations, and through LockFreeBoundedBuffer, which claims
+// slots with atomics instead.
+//
+
+namespace {
+
+constexpr auto buffer_size = 64;
+constexpr auto n_items = 200'000;
+
+// Longer than the small string buffer, each payload owns a heap block
+const auto payload = std::string(48, 'x');
+
+// Returns the number of items transferred
+template <typename Buffer>
+auto transfer(Buffer& buffer, int n_producers, int n_consumers) {
+  const auto per_producer = n_items / n_producers;
+  const auto total = per_producer * n_producers;
+  auto threads = std::vector<std::jthread>{};
+  for (auto p = 0; p < n_producers; ++p) {
+    threads.emplace_back([&buffer, per_producer] {
+      for (auto i = 0; i < per_producer; ++i) {
+        buffer.push(payload);
+      }
+    });
+  }
+  for (auto c = 0; c < n_consumers; ++c) {
+    // The last consumer takes the remainder
+    const auto n = total / n_consumers +
+                   (c == n_consumers - 1 ? total % n_consumers : 0);
+    threads.emplace_back([&buffer, n] {
+      for (auto i = 0; i < n; ++i) {
+        benchmark::DoNotOptimize(buffer.pop());
+      }
+    });
+  }
+  return total;
+}
+
+template <typename Buffer>
+void bm_buffer(benchmark::State& state) {
+  const auto n_producers = static_cast<int>(state.range(0));
+  const auto n_consumers = static_cast<int>(state.range(1));
+  auto buffer = std::make_unique<Buffer>();
+  auto n = int64_t{0};
+  for (auto _ : state) {
+    n += transfer(*buffer, n_producers, n_consumers);
+  }
+  state.SetItemsProcessed(n);
+}
+
+using Locked = BoundedBuffer<std::string, buffer_size>;
+using LockFree = LockFreeBoundedBuffer<std::string, buffer_size>;
+
+void CustomArguments(benchmark::internal::Benchmark* b) {
+  const auto n = static_cast<int>(
+      std::max(1u, std::thread::hardware_concurrency()));
+  b->ArgNames({"producers", "consumers"});
+  b->Args({1, 1})->Args({4, 4})->Args({1, 8})->Args({8, 1});
+  if (n > 4) {
+    b->Args({n, n});
+  }
+  b->UseRealTime()->Unit(benchmark::kMillisecond);
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(bm_buffer, Locked)->Apply(CustomArguments);
+BENCHMARK_TEMPLATE(bm_buffer, LockFree)->Apply(CustomArguments);
+
+BENCHMARK_MAIN();
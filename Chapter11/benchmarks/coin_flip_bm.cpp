@@ -0,0 +1,80 @@
+#include "../per_thread.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+
+//
+// Coin flips per second when the outcomes are counted in a shared Stats
+// object using std::atomic_ref, like in atomic_references.cpp, compared
+// against counting in one slot per thread. The unpadded slots share cache
+// lines and show the cost of false sharing.
+//
+
+namespace {
+
+constexpr auto flips_per_iteration = 1000;
+
+struct Stats {
+  int heads{};
+  int tails{};
+};
+
+auto flip() {
+  static thread_local auto engine = std::mt19937{std::random_device{}()};
+  return (engine() & 1) == 0;
+}
+
+const auto max_threads = std::max(1u, std::thread::hardware_concurrency());
+
+void bm_atomic_ref(benchmark::State& state) {
+  static auto stats = Stats{};
+  auto heads = std::atomic_ref<int>{stats.heads};
+  auto tails = std::atomic_ref<int>{stats.tails};
+  for (auto _ : state) {
+    for (auto i = 0; i < flips_per_iteration; ++i) {
+      flip() ? ++heads : ++tails;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * flips_per_iteration);
+}
+
+void bm_unpadded_slots(benchmark::State& state) {
+  static auto slots = std::vector<Stats>(max_threads);
+  auto& s = slots[state.thread_index()];
+  for (auto _ : state) {
+    for (auto i = 0; i < flips_per_iteration; ++i) {
+      flip() ? ++s.heads : ++s.tails;
+      benchmark::ClobberMemory(); // Keep the counters in memory
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * flips_per_iteration);
+}
+
+void bm_per_thread(benchmark::State& state) {
+  static auto slots = PerThread<Stats>{max_threads};
+  auto& s = slots[state.thread_index()];
+  for (auto _ : state) {
+    for (auto i = 0; i < flips_per_iteration; ++i) {
+      flip() ? ++s.heads : ++s.tails;
+      benchmark::ClobberMemory(); // Keep the counters in memory
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * flips_per_iteration);
+}
+
+void ThreadArguments(benchmark::internal::Benchmark* b) {
+  b->ThreadRange(1, max_threads)->UseRealTime()->Unit(benchmark::kMicrosecond);
+}
+
+} // namespace
+
+BENCHMARK(bm_atomic_ref)->Apply(ThreadArguments);
+BENCHMARK(bm_unpadded_slots)->Apply(ThreadArguments);
+BENCHMARK(bm_per_thread)->Apply(ThreadArguments);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,79 @@
+#include "../continuable_future.h"
+
+#include <benchmark/benchmark.h>
+
+#include <future>
+#include <stdexcept>
+#include <utility>
+
+//
+// A chain of divide() calls where each step consumes the result of the
+// previous one. With std::future, each step is a std::async() task blocked
+// in get() until the previous step is done. With Future, each step is a
+// then() continuation, run inline by the thread that sets the value or on
+// a ThreadPoolExecutor. The chain length is the argument.
+//
+
+namespace {
+
+int divide(int a, int b) {
+  if (b == 0) {
+    throw std::runtime_error("Divide by zero exception");
+  }
+  return a / b;
+}
+
+void bm_std_future(benchmark::State& state) {
+  const auto n = state.range(0);
+  for (auto _ : state) {
+    auto p = std::promise<int>{};
+    auto f = p.get_future();
+    for (auto i = 0; i < n; ++i) {
+      f = std::async(std::launch::async, [prev = std::move(f)]() mutable {
+        return divide(prev.get(), 1);
+      });
+    }
+    p.set_value(45);
+    benchmark::DoNotOptimize(f.get());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+void bm_future_then(benchmark::State& state, Executor& executor) {
+  const auto n = state.range(0);
+  const auto n_upstream = SharedStatePool::upstream_allocations();
+  for (auto _ : state) {
+    auto p = Promise<int>{executor};
+    auto f = p.get_future();
+    for (auto i = 0; i < n; ++i) {
+      f = f.then([](int x) { return divide(x, 1); });
+    }
+    p.set_value(45);
+    benchmark::DoNotOptimize(f.get());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+  state.counters["upstream_allocs"] = static_cast<double>(
+      SharedStatePool::upstream_allocations() - n_upstream);
+}
+
+void bm_future_inline(benchmark::State& state) {
+  bm_future_then(state, InlineExecutor::instance());
+}
+
+void bm_future_thread_pool(benchmark::State& state) {
+  static auto pool = ThreadPoolExecutor{};
+  bm_future_then(state, pool);
+}
+
+void CustomArguments(benchmark::internal::Benchmark* b) {
+  b->ArgName("chain")->Arg(1)->Arg(8)->Arg(64);
+  b->UseRealTime()->Unit(benchmark::kMicrosecond);
+}
+
+} // namespace
+
+BENCHMARK(bm_std_future)->Apply(CustomArguments);
+BENCHMARK(bm_future_inline)->Apply(CustomArguments);
+BENCHMARK(bm_future_thread_pool)->Apply(CustomArguments);
+
+BENCHMARK_MAIN();
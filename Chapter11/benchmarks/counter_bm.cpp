@@ -0,0 +1,65 @@
+#include "../sharded_counter.h"
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+//
+// Increments per second from 1 to 64 threads on one shared counter, using
+// the atomic counter of counter_atomic.cpp, the mutex guarded counter of
+// counter_mutex.cpp and a ShardedCounter.
+//
+
+namespace {
+
+constexpr auto increments_per_iteration = 100;
+
+void bm_counter_atomic(benchmark::State& state) {
+  // 64 bits, an int would overflow in long runs
+  static auto counter = std::atomic<std::uint64_t>{0};
+  for (auto _ : state) {
+    for (auto i = 0; i < increments_per_iteration; ++i) {
+      ++counter;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * increments_per_iteration);
+}
+
+void bm_counter_mutex(benchmark::State& state) {
+  static auto counter = std::uint64_t{0}; // Protected by counter_mutex
+  static auto counter_mutex = std::mutex{};
+  for (auto _ : state) {
+    for (auto i = 0; i < increments_per_iteration; ++i) {
+      auto lock = std::scoped_lock{counter_mutex};
+      ++counter;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * increments_per_iteration);
+}
+
+void bm_counter_sharded(benchmark::State& state) {
+  static auto counter = ShardedCounter{};
+  for (auto _ : state) {
+    for (auto i = 0; i < increments_per_iteration; ++i) {
+      ++counter;
+    }
+  }
+  if (state.thread_index() == 0) {
+    benchmark::DoNotOptimize(counter.load());
+  }
+  state.SetItemsProcessed(state.iterations() * increments_per_iteration);
+}
+
+void CustomArguments(benchmark::internal::Benchmark* b) {
+  b->ThreadRange(1, 64)->UseRealTime();
+}
+
+} // namespace
+
+BENCHMARK(bm_counter_atomic)->Apply(CustomArguments);
+BENCHMARK(bm_counter_mutex)->Apply(CustomArguments);
+BENCHMARK(bm_counter_sharded)->Apply(CustomArguments);
+
+BENCHMARK_MAIN();
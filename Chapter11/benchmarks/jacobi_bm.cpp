@@ -0,0 +1,137 @@
+#include "../../Chapter05/grid.h"
+#include "../per_thread.h"
+#include "../phase_engine.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <thread>
+#include <utility>
+#include <vector>
+
+//
+// Jacobi iterations on the Grid from Chapter05, where every inner cell
+// becomes the average of its four neighbours. Each step reads one grid and
+// writes the other, and the largest change is reduced to check for
+// convergence. The rows are split between the threads, which are either
+// created for every step or kept in a PhaseEngine. The grid side is the
+// argument.
+//
+
+namespace {
+
+constexpr auto n_steps = std::size_t{20};
+
+auto make_grid(std::size_t side) {
+  auto grid = Grid<double>{side, side};
+  auto top = grid.get_row_v3(0);
+  std::fill(top.begin(), top.end(), 1.0); // A hot edge
+  return grid;
+}
+
+// Updates the inner rows [first, last) and returns the largest change
+auto jacobi_rows(const Grid<double>& in, Grid<double>& out, std::size_t first,
+                 std::size_t last) {
+  const auto w = in.w_;
+  const auto* src = in.data_.data();
+  auto* dst = out.data_.data();
+  auto change = 0.0;
+  for (auto y = first; y < last; ++y) {
+    for (std::size_t x = 1; x + 1 < w; ++x) {
+      const auto i = y * w + x;
+      dst[i] = 0.25 * (src[i - 1] + src[i + 1] + src[i - w] + src[i + w]);
+      change = std::max(change, std::abs(dst[i] - src[i]));
+    }
+  }
+  return change;
+}
+
+auto n_threads() { return std::max(1u, std::thread::hardware_concurrency()); }
+
+void bm_sequential(benchmark::State& state) {
+  const auto side = static_cast<std::size_t>(state.range(0));
+  for (auto _ : state) {
+    auto a = make_grid(side);
+    auto b = a;
+    auto change = 0.0;
+    for (std::size_t step = 0; step < n_steps; ++step) {
+      change = jacobi_rows(a, b, 1, side - 1);
+      std::swap(a, b);
+    }
+    benchmark::DoNotOptimize(change);
+  }
+  state.SetItemsProcessed(state.iterations() * n_steps * side * side);
+}
+
+void bm_spawn_per_step(benchmark::State& state) {
+  const auto side = static_cast<std::size_t>(state.range(0));
+  const auto n = n_threads();
+  for (auto _ : state) {
+    auto a = make_grid(side);
+    auto b = a;
+    auto changes = PerThread<double>{n};
+    auto change = 0.0;
+    for (std::size_t step = 0; step < n_steps; ++step) {
+      {
+        auto threads = std::vector<std::jthread>{};
+        for (std::size_t t = 0; t < n; ++t) {
+          threads.emplace_back([&, t] {
+            const auto chunk = (side - 2 + n - 1) / n;
+            const auto first = std::min(side - 1, 1 + t * chunk);
+            const auto last = std::min(side - 1, first + chunk);
+            changes[t] = jacobi_rows(a, b, first, last);
+          });
+        }
+      }
+      change = changes.combine(0.0, [](double x, double y) {
+        return std::max(x, y);
+      });
+      std::swap(a, b);
+    }
+    benchmark::DoNotOptimize(change);
+  }
+  state.SetItemsProcessed(state.iterations() * n_steps * side * side);
+}
+
+void bm_phase_engine(benchmark::State& state) {
+  const auto side = static_cast<std::size_t>(state.range(0));
+  static auto engine = PhaseEngine{n_threads()};
+  for (auto _ : state) {
+    auto a = make_grid(side);
+    auto b = a;
+    auto* in = &a;
+    auto* out = &b;
+    auto changes = PerThread<double>{engine.size()};
+    auto change = 0.0;
+    engine.run(
+        n_steps,
+        [&](std::size_t w, std::size_t) {
+          const auto [first, last] = engine.partition(side - 2, w);
+          changes[w] = jacobi_rows(*in, *out, first + 1, last + 1);
+        },
+        [&](std::size_t) {
+          change = changes.combine(0.0, [](double x, double y) {
+            return std::max(x, y);
+          });
+          std::swap(in, out);
+          return change > 0.0;
+        });
+    benchmark::DoNotOptimize(change);
+  }
+  state.SetItemsProcessed(state.iterations() * n_steps * side * side);
+}
+
+void CustomArguments(benchmark::internal::Benchmark* b) {
+  b->ArgName("side")->Arg(64)->Arg(256)->Arg(1024);
+  b->UseRealTime()->Unit(benchmark::kMicrosecond);
+}
+
+} // namespace
+
+BENCHMARK(bm_sequential)->Apply(CustomArguments);
+BENCHMARK(bm_spawn_per_step)->Apply(CustomArguments);
+BENCHMARK(bm_phase_engine)->Apply(CustomArguments);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,65 @@
+#include "../spin_locks.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+//
+// Threads incrementing a shared counter, as in the increment_counter
+// functions of counter_mutex.cpp and atomics.cpp, protected by different
+// locks. The critical section length is the number of increments done
+// while holding the lock. SimpleMutex is the test-and-set lock from
+// atomics.cpp.
+//
+
+namespace {
+
+class SimpleMutex {
+  std::atomic_flag is_locked{}; // Cleared by default
+public:
+  auto lock() noexcept {
+    while (is_locked.test_and_set()) {
+      while (is_locked.test()) // C++20
+        ;                      // Spin here
+    }
+  }
+  auto unlock() noexcept { is_locked.clear(); }
+};
+
+template <typename Lock>
+void bm_lock(benchmark::State& state) {
+  static auto counter_mutex = Lock{};
+  static auto counter = int64_t{0}; // Counter will be protected by mutex
+  const auto critical_section_length = state.range(0);
+  for (auto _ : state) {
+    counter_mutex.lock();
+    for (auto i = 0; i < critical_section_length; ++i) {
+      ++counter;
+      benchmark::ClobberMemory(); // Keep the counter in memory
+    }
+    counter_mutex.unlock();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void CustomArguments(benchmark::internal::Benchmark* b) {
+  const auto n = static_cast<int>(
+      std::max(1u, std::thread::hardware_concurrency()));
+  b->ArgName("cs_length")->Arg(1)->Arg(16)->Arg(256);
+  b->ThreadRange(1, n)->UseRealTime();
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(bm_lock, std::mutex)->Apply(CustomArguments);
+BENCHMARK_TEMPLATE(bm_lock, SimpleMutex)->Apply(CustomArguments);
+BENCHMARK_TEMPLATE(bm_lock, TtasLock)->Apply(CustomArguments);
+BENCHMARK_TEMPLATE(bm_lock, TicketLock)->Apply(CustomArguments);
+BENCHMARK_TEMPLATE(bm_lock, McsLock)->Apply(CustomArguments);
+BENCHMARK_TEMPLATE(bm_lock, AdaptiveLock)->Apply(CustomArguments);
+
+BENCHMARK_MAIN();
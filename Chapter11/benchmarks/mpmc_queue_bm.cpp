@@ -0,0 +1,115 @@
+#include "../mpmc_queue.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <thread>
+#include <vector>
+
+//
+// Throughput of passing integers from P producers to C consumers through
+// the lock-free MpmcQueue, compared against a std::queue protected by a
+// mutex. Each iteration starts the threads and moves a fixed number of
+// items through the queue.
+//
+
+namespace {
+
+constexpr auto queue_size = size_t{1024};
+constexpr auto n_items = 1'000'000;
+
+// Baseline, bounded queue guarded by a single mutex
+template <typename T, size_t N>
+class LockedQueue {
+public:
+  auto try_push(T t) {
+    auto lock = std::scoped_lock{mutex_};
+    if (queue_.size() == N) {
+      return false;
+    }
+    queue_.push(std::move(t));
+    return true;
+  }
+  auto try_pop() -> std::optional<T> {
+    auto lock = std::scoped_lock{mutex_};
+    if (queue_.empty()) {
+      return std::nullopt;
+    }
+    auto val = std::optional<T>{std::move(queue_.front())};
+    queue_.pop();
+    return val;
+  }
+
+private:
+  std::mutex mutex_;
+  std::queue<T> queue_;
+};
+
+// Returns the number of items transferred
+template <typename Queue>
+auto transfer(Queue& queue, int n_producers, int n_consumers) {
+  const auto per_producer = n_items / n_producers;
+  const auto total = per_producer * n_producers;
+  auto threads = std::vector<std::jthread>{};
+  for (auto p = 0; p < n_producers; ++p) {
+    threads.emplace_back([&queue, per_producer] {
+      for (auto i = 0; i < per_producer; ++i) {
+        while (!queue.try_push(i)) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (auto c = 0; c < n_consumers; ++c) {
+    // The last consumer takes the remainder
+    const auto n = total / n_consumers +
+                   (c == n_consumers - 1 ? total % n_consumers : 0);
+    threads.emplace_back([&queue, n] {
+      for (auto i = 0; i < n; ++i) {
+        while (!queue.try_pop()) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  return total;
+}
+
+template <typename Queue>
+void bm_queue(benchmark::State& state) {
+  const auto n_producers = static_cast<int>(state.range(0));
+  const auto n_consumers = static_cast<int>(state.range(1));
+  auto queue = std::make_unique<Queue>();
+  auto n = int64_t{0};
+  for (auto _ : state) {
+    n += transfer(*queue, n_producers, n_consumers);
+  }
+  state.SetItemsProcessed(n);
+}
+
+using LockFree = MpmcQueue<int, queue_size>;
+using Locked = LockedQueue<int, queue_size>;
+
+// 1P1C, 4P4C and NPNC where N is the number of hardware threads
+void CustomArguments(benchmark::internal::Benchmark* b) {
+  const auto n = static_cast<int>(
+      std::max(1u, std::thread::hardware_concurrency()));
+  b->ArgNames({"producers", "consumers"});
+  b->Args({1, 1})->Args({4, 4});
+  if (n != 1 && n != 4) {
+    b->Args({n, n});
+  }
+  b->UseRealTime()->Unit(benchmark::kMillisecond);
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(bm_queue, LockFree)->Apply(CustomArguments);
+BENCHMARK_TEMPLATE(bm_queue, Locked)->Apply(CustomArguments);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,129 @@
+#include "../rcu_ptr.h"
+#include "../seqlock.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+
+//
+// Two account balances that are mostly read and sometimes transferred
+// between, with the percentage of writes as argument. The baseline locks
+// one mutex per account with std::scoped_lock like avoid_deadlock.cpp. The
+// other versions keep both balances in one object guarded by a
+// std::shared_mutex, a SeqLock or an RcuPtr.
+//
+
+namespace {
+
+struct Balances {
+  int from_{100};
+  int to_{30};
+};
+
+struct Account {
+  int balance_{0};
+  std::mutex m_{};
+};
+
+class ScopedLockBank {
+public:
+  auto total() {
+    auto lock = std::scoped_lock{a_.m_, b_.m_};
+    return a_.balance_ + b_.balance_;
+  }
+  void transfer(int amount) {
+    auto lock = std::scoped_lock{a_.m_, b_.m_};
+    a_.balance_ -= amount;
+    b_.balance_ += amount;
+  }
+
+private:
+  Account a_{100};
+  Account b_{30};
+};
+
+class SharedMutexBank {
+public:
+  auto total() {
+    auto lock = std::shared_lock{m_};
+    return balances_.from_ + balances_.to_;
+  }
+  void transfer(int amount) {
+    auto lock = std::unique_lock{m_};
+    balances_.from_ -= amount;
+    balances_.to_ += amount;
+  }
+
+private:
+  std::shared_mutex m_{};
+  Balances balances_{};
+};
+
+class SeqLockBank {
+public:
+  auto total() {
+    const auto b = balances_.load();
+    return b.from_ + b.to_;
+  }
+  void transfer(int amount) {
+    balances_.modify([amount](Balances& b) {
+      b.from_ -= amount;
+      b.to_ += amount;
+    });
+  }
+
+private:
+  SeqLock<Balances> balances_{};
+};
+
+class RcuBank {
+public:
+  auto total() {
+    auto b = balances_.read();
+    return b->from_ + b->to_;
+  }
+  void transfer(int amount) {
+    balances_.update([amount](Balances& b) {
+      b.from_ -= amount;
+      b.to_ += amount;
+    });
+  }
+
+private:
+  RcuPtr<Balances> balances_{std::make_unique<Balances>()};
+};
+
+template <typename Bank>
+void bm_read_mostly(benchmark::State& state) {
+  static auto bank = Bank{};
+  const auto write_percentage = state.range(0);
+  auto i = int64_t{0};
+  for (auto _ : state) {
+    if (i++ % 100 < write_percentage) {
+      bank.transfer(1);
+    } else {
+      benchmark::DoNotOptimize(bank.total());
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void CustomArguments(benchmark::internal::Benchmark* b) {
+  const auto n = static_cast<int>(
+      std::max(1u, std::thread::hardware_concurrency()));
+  b->ArgName("write_pct")->Arg(0)->Arg(1)->Arg(10)->Arg(50);
+  b->ThreadRange(1, n)->UseRealTime();
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(bm_read_mostly, ScopedLockBank)->Apply(CustomArguments);
+BENCHMARK_TEMPLATE(bm_read_mostly, SharedMutexBank)->Apply(CustomArguments);
+BENCHMARK_TEMPLATE(bm_read_mostly, SeqLockBank)->Apply(CustomArguments);
+BENCHMARK_TEMPLATE(bm_read_mostly, RcuBank)->Apply(CustomArguments);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,142 @@
+#include "../lock_free_queue.h"
+#include "../spsc_queue.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <span>
+#include <thread>
+
+//
+// Messages per second from one writer thread to one reader thread through
+// the LockFreeQueue of the book, compared against SpscQueue with one
+// element or one batch of elements per synchronization, and with the
+// blocking functions.
+//
+
+namespace {
+
+constexpr auto queue_size = size_t{1024};
+constexpr auto n_messages = 1'000'000;
+
+template <typename Queue>
+void bm_single(benchmark::State& state) {
+  auto queue = std::make_unique<Queue>();
+  for (auto _ : state) {
+    auto writer = std::jthread{[&queue] {
+      for (auto i = 0; i < n_messages; ++i) {
+        while (!queue->push(i)) {
+          std::this_thread::yield();
+        }
+      }
+    }};
+    auto sum = int64_t{0};
+    for (auto i = 0; i < n_messages; ++i) {
+      auto val = queue->pop();
+      while (!val) {
+        std::this_thread::yield();
+        val = queue->pop();
+      }
+      sum += *val;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * n_messages);
+}
+
+void bm_batch(benchmark::State& state) {
+  const auto batch_size = static_cast<size_t>(state.range(0));
+  auto queue = std::make_unique<SpscQueue<int, queue_size>>();
+  for (auto _ : state) {
+    auto writer = std::jthread{[&queue, batch_size] {
+      auto batch = std::array<int, queue_size>{};
+      for (auto i = 0; i < n_messages;) {
+        const auto n = std::min<size_t>(batch_size, n_messages - i);
+        std::iota(batch.begin(), batch.begin() + n, i);
+        auto pushed = size_t{0};
+        while (pushed < n) {
+          const auto k = queue->push_n({batch.data() + pushed, n - pushed});
+          if (k == 0) {
+            std::this_thread::yield();
+          }
+          pushed += k;
+        }
+        i += static_cast<int>(n);
+      }
+    }};
+    auto batch = std::array<int, queue_size>{};
+    auto sum = int64_t{0};
+    for (auto received = 0; received < n_messages;) {
+      const auto k = queue->pop_n({batch.data(), batch_size});
+      if (k == 0) {
+        std::this_thread::yield();
+      }
+      for (size_t j = 0; j < k; ++j) {
+        sum += batch[j];
+      }
+      received += static_cast<int>(k);
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * n_messages);
+}
+
+// Blocking mode, where both threads park instead of yielding
+void bm_blocking(benchmark::State& state) {
+  auto queue = std::make_unique<SpscQueue<int, queue_size>>();
+  for (auto _ : state) {
+    auto writer = std::jthread{[&queue] {
+      for (auto i = 0; i < n_messages; ++i) {
+        queue->push_wait(i);
+      }
+    }};
+    auto sum = int64_t{0};
+    for (auto i = 0; i < n_messages; ++i) {
+      sum += queue->pop_wait();
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * n_messages);
+}
+
+// Round trip between two threads, where the echo thread is parked between
+// the messages
+void bm_ping_pong(benchmark::State& state) {
+  auto ping = std::make_unique<SpscQueue<int, 2>>();
+  auto pong = std::make_unique<SpscQueue<int, 2>>();
+  auto echo = std::jthread{[&ping, &pong] {
+    for (auto i = ping->pop_wait(); i >= 0; i = ping->pop_wait()) {
+      pong->push_wait(i);
+    }
+  }};
+  for (auto _ : state) {
+    ping->push_wait(1);
+    benchmark::DoNotOptimize(pong->pop_wait());
+  }
+  ping->push_wait(-1);
+}
+
+using Book = LockFreeQueue<int, queue_size>;
+using Spsc = SpscQueue<int, queue_size>;
+
+} // namespace
+
+BENCHMARK_TEMPLATE(bm_single, Book)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(bm_single, Spsc)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(bm_batch)
+    ->RangeMultiplier(4)
+    ->Range(4, 256)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(bm_blocking)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(bm_ping_pong)->UseRealTime()->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <semaphore>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+template <class T, int N> class BoundedBuffer {
+  std::array<T, N> buf_;
+  std::size_t read_pos_{};
+  std::size_t write_pos_{};
+  std::mutex m_;
+  std::counting_semaphore<N> n_empty_slots_{N}; // New
+  std::counting_semaphore<N> n_full_slots_{0};  // New
+
+  void do_push(auto&& item) {
+    // Take one of the empty slots (might block)
+    n_empty_slots_.acquire(); // New
+    try {
+      auto lock = std::unique_lock{m_};
+      buf_[write_pos_] = std::forward<decltype(item)>(item);
+      write_pos_ = (write_pos_ + 1) % N;
+    } catch (...) {
+      n_empty_slots_.release();
+      throw;
+    }
+    // Increment and signal that there is one more full slot
+    n_full_slots_.release(); // New
+  }
+
+public:
+  void push(const T& item) { do_push(item); }
+  void push(T&& item) { do_push(std::move(item)); }
+
+  auto pop() {
+    // Take one of the full slots (might block)
+    n_full_slots_.acquire(); // New
+    auto item = std::optional<T>{};
+    try {
+      auto lock = std::unique_lock{m_};
+      item = std::move(buf_[read_pos_]);
+      read_pos_ = (read_pos_ + 1) % N;
+    } catch (...) {
+      n_full_slots_.release();
+      throw;
+    }
+    // Increment and signal that there is one more empty slot
+    n_empty_slots_.release(); // New
+    return std::move(*item);
+  }
+};
+
+// Same blocking semantics as BoundedBuffer, but without the mutex. The
+// semaphores still decide when a thread may proceed, while the slots are
+// claimed with a fetch_add() on the read or write position. A semaphore
+// only guarantees that some slot is free (or full), not that the claimed
+// one is, since threads can finish out of order. Each slot therefore has
+// a sequence number, as in MpmcQueue, which a thread waits for. The wait
+// is almost always over immediately.
+template <class T, int N> class LockFreeBoundedBuffer {
+  static_assert(std::is_nothrow_move_assignable_v<T>);
+
+  struct Slot {
+    std::atomic<std::size_t> sequence_{};
+    T value_{};
+  };
+  std::array<Slot, N> buf_;
+  std::atomic<std::size_t> read_pos_{};
+  std::atomic<std::size_t> write_pos_{};
+  std::counting_semaphore<N> n_empty_slots_{N};
+  std::counting_semaphore<N> n_full_slots_{0};
+
+  static void wait_for(const Slot& slot, std::size_t sequence) noexcept {
+    while (slot.sequence_.load(std::memory_order_acquire) != sequence) {
+      std::this_thread::yield();
+    }
+  }
+
+  void do_push(T&& item) {
+    n_empty_slots_.acquire();
+    const auto pos = write_pos_.fetch_add(1, std::memory_order_relaxed);
+    auto& slot = buf_[pos % N];
+    wait_for(slot, pos);
+    slot.value_ = std::move(item);
+    slot.sequence_.store(pos + 1, std::memory_order_release);
+    n_full_slots_.release();
+  }
+
+public:
+  LockFreeBoundedBuffer() {
+    for (std::size_t i = 0; i < N; ++i) {
+      buf_[i].sequence_.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  // A copy is made before a slot is claimed, since a claimed slot must be
+  // filled
+  void push(const T& item) { do_push(T(item)); }
+  void push(T&& item) { do_push(std::move(item)); }
+
+  auto pop() {
+    n_full_slots_.acquire();
+    const auto pos = read_pos_.fetch_add(1, std::memory_order_relaxed);
+    auto& slot = buf_[pos % N];
+    wait_for(slot, pos + 1);
+    auto item = std::move(slot.value_);
+    slot.sequence_.store(pos + N, std::memory_order_release);
+    n_empty_slots_.release();
+    return item;
+  }
+};
@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+
+#include "continuable_future.h"
+
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+int divide(int a, int b) {
+  if (b == 0) {
+    throw std::runtime_error{"Divide by zero exception"};
+  }
+  return a / b;
+}
+
+} // namespace
+
+TEST(ContinuableFuture, ThenChain) {
+  auto p = Promise<int>{};
+  auto f = p.get_future()
+               .then([](int x) { return divide(x, 5); })
+               .then([](int x) { return std::to_string(x); });
+  ASSERT_FALSE(f.is_ready());
+  p.set_value(45);
+  ASSERT_TRUE(f.is_ready());
+  ASSERT_EQ(f.get(), "9");
+  ASSERT_FALSE(f.valid());
+}
+
+TEST(ContinuableFuture, ExceptionsSkipTheRestOfTheChain) {
+  auto p = Promise<int>{};
+  auto n_calls = 0;
+  auto f = p.get_future()
+               .then([](int x) { return divide(x, 0); })
+               .then([&n_calls](int x) { return ++n_calls + x; });
+  p.set_value(45);
+  ASSERT_THROW(f.get(), std::runtime_error);
+  ASSERT_EQ(n_calls, 0);
+
+  auto broken = Promise<int>{}.get_future();
+  ASSERT_THROW(broken.get(), std::future_error);
+}
+
+TEST(ContinuableFuture, ThenOnThreadPool) {
+  auto pool = ThreadPoolExecutor{2};
+  auto p = Promise<int>{pool};
+  auto f = p.get_future();
+  for (auto i = 0; i < 100; ++i) {
+    f = f.then([](int x) { return x + 1; });
+  }
+  auto t = std::jthread{[&p] { p.set_value(0); }};
+  ASSERT_EQ(f.get(), 100); // Blocks until the chain is done
+}
+
+TEST(ContinuableFuture, WhenAllAndWhenAny) {
+  auto pool = ThreadPoolExecutor{2};
+  auto promises = std::vector<Promise<int>>{};
+  auto futures = std::vector<Future<int>>{};
+  for (auto i = 0; i < 4; ++i) {
+    promises.emplace_back(pool);
+    futures.push_back(promises.back().get_future().then(
+        [](int x) { return divide(x, 2); }));
+  }
+  auto all = when_all(std::move(futures)).then([](std::vector<int> v) {
+    return std::accumulate(v.begin(), v.end(), 0);
+  });
+  auto threads = std::vector<std::jthread>{};
+  for (auto i = 0; i < 4; ++i) {
+    threads.emplace_back([&promises, i] { promises[i].set_value(10 * i); });
+  }
+  ASSERT_EQ(all.get(), 0 + 5 + 10 + 15);
+
+  auto a = Promise<int>{};
+  auto b = Promise<int>{};
+  auto inputs = std::vector<Future<int>>{};
+  inputs.push_back(a.get_future());
+  inputs.push_back(b.get_future());
+  auto any = when_any(std::move(inputs));
+  b.set_value(7);
+  a.set_value(3);
+  const auto [index, value] = any.get();
+  ASSERT_EQ(index, 1u);
+  ASSERT_EQ(value, 7);
+}
+
+TEST(ContinuableFuture, SharedStatesAreRecycled) {
+  auto run_chain = [] {
+    auto p = Promise<int>{};
+    auto f = p.get_future();
+    for (auto i = 0; i < 10; ++i) {
+      f = f.then([](int x) { return x + 1; });
+    }
+    p.set_value(0);
+    return f.get();
+  };
+  ASSERT_EQ(run_chain(), 10);
+  const auto n_upstream = SharedStatePool::upstream_allocations();
+  for (auto i = 0; i < 100; ++i) {
+    ASSERT_EQ(run_chain(), 10);
+  }
+  ASSERT_EQ(SharedStatePool::upstream_allocations(), n_upstream);
+}
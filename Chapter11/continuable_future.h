@@ -0,0 +1,647 @@
+#pragma once
+
+#include "mpmc_queue.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <semaphore>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+//
+// A future and promise pair where a continuation is attached with then()
+// instead of blocking a thread in get(). The continuation runs on an
+// executor once the value is set. when_all() and when_any() combine several
+// futures into one.
+//
+// The shared state is reference counted and allocated from
+// SharedStatePool. A then() continuation is stored inside the shared state
+// of the future it returns, so a step in a chain is one pooled allocation.
+// Readiness and the continuation are kept in one atomic pointer, which is
+// either empty, a continuation, a marker for a thread blocked in get(), or
+// a marker for ready. Setting a value and attaching a continuation are
+// both a single atomic operation, without a mutex.
+//
+
+// Intrusive callback, used for continuations and for work given to an
+// executor
+struct Callback {
+  void (*invoke_)(Callback*) noexcept {};
+  void operator()() noexcept { invoke_(this); }
+};
+
+class Executor {
+public:
+  virtual ~Executor() = default;
+  // The callback must stay alive until it has been invoked
+  virtual void execute(Callback& cb) = 0;
+};
+
+// Runs the callback right away on the calling thread
+class InlineExecutor : public Executor {
+public:
+  void execute(Callback& cb) override { cb(); }
+  static auto instance() -> InlineExecutor& {
+    static auto executor = InlineExecutor{};
+    return executor;
+  }
+};
+
+// A fixed number of threads taking callbacks from an MpmcQueue. Idle
+// threads sleep on a semaphore. A callback that executes more work than
+// the queue can hold will block.
+class ThreadPoolExecutor : public Executor {
+public:
+  explicit ThreadPoolExecutor(
+      unsigned n_threads = std::max(1u, std::thread::hardware_concurrency())) {
+    for (auto i = 0u; i < n_threads; ++i) {
+      threads_.emplace_back([this] {
+        for (;;) {
+          n_queued_.acquire();
+          auto* cb = queue_.pop();
+          if (cb == nullptr) {
+            return;
+          }
+          (*cb)();
+        }
+      });
+    }
+  }
+  ~ThreadPoolExecutor() override {
+    for (auto i = 0u; i < threads_.size(); ++i) {
+      queue_.push(nullptr); // Tells one thread to exit
+      n_queued_.release();
+    }
+  }
+  void execute(Callback& cb) override {
+    queue_.push(&cb);
+    n_queued_.release();
+  }
+
+private:
+  MpmcQueue<Callback*, 1024> queue_{};
+  std::counting_semaphore<> n_queued_{0};
+  std::vector<std::jthread> threads_{};
+};
+
+//
+// Memory for shared states, in size classes of 64 bytes up to 512 bytes.
+// Each thread keeps a free list per size class. When a list grows too
+// long, half of it is moved to a shared depot, and an empty list is
+// refilled from the depot, so memory freed on another thread comes back
+// without a lock per allocation.
+//
+class SharedStatePool {
+public:
+  static constexpr std::size_t granularity = 64;
+  static constexpr std::size_t max_size = 512;
+  static constexpr std::size_t batch_size = 32;
+
+  static auto allocate(std::size_t n) -> void*;
+  static void deallocate(void* p, std::size_t n) noexcept;
+
+  // Number of blocks taken from operator new, by all threads
+  static auto upstream_allocations() noexcept {
+    return n_upstream().load(std::memory_order_relaxed);
+  }
+
+private:
+  static constexpr std::size_t n_classes = max_size / granularity;
+
+  struct Block {
+    Block* next_{};
+  };
+  // A singly linked list that knows its length
+  struct FreeList {
+    Block* head_{};
+    std::size_t size_{};
+    void push(Block* b) noexcept {
+      b->next_ = head_;
+      head_ = b;
+      ++size_;
+    }
+    auto pop() noexcept {
+      auto* b = head_;
+      head_ = b->next_;
+      --size_;
+      return b;
+    }
+    // Moves up to n blocks to other
+    void move_to(FreeList& other, std::size_t n) noexcept {
+      while (head_ != nullptr && n-- > 0) {
+        other.push(pop());
+      }
+    }
+  };
+  struct LocalLists {
+    std::array<FreeList, n_classes> lists_{};
+    ~LocalLists() {
+      // Give the blocks to the depot, other threads may still use them
+      auto& depot = SharedStatePool::depot();
+      auto lock = std::scoped_lock{depot.mutex_};
+      for (std::size_t i = 0; i < n_classes; ++i) {
+        lists_[i].move_to(depot.lists_[i], lists_[i].size_);
+      }
+    }
+  };
+  struct Depot {
+    std::mutex mutex_{};
+    std::array<FreeList, n_classes> lists_{};
+  };
+
+  static auto size_class(std::size_t n) noexcept {
+    return (n + granularity - 1) / granularity - 1;
+  }
+  static auto local() -> LocalLists& {
+    static thread_local auto lists = LocalLists{};
+    return lists;
+  }
+  // Never destroyed, threads may exit after static destruction has begun,
+  // for example the workers of a static thread pool. The blocks left in the
+  // depot are reclaimed when the process exits.
+  static auto depot() -> Depot& {
+    static auto* d = new Depot{};
+    return *d;
+  }
+  static auto n_upstream() -> std::atomic<std::size_t>& {
+    static auto n = std::atomic<std::size_t>{0};
+    return n;
+  }
+};
+
+inline auto SharedStatePool::allocate(std::size_t n) -> void* {
+  if (n > max_size) {
+    return ::operator new(n);
+  }
+  const auto c = size_class(n);
+  auto& list = local().lists_[c];
+  if (list.head_ == nullptr) {
+    auto& d = depot();
+    auto lock = std::scoped_lock{d.mutex_};
+    d.lists_[c].move_to(list, batch_size);
+  }
+  if (list.head_ == nullptr) {
+    n_upstream().fetch_add(1, std::memory_order_relaxed);
+    return ::operator new((c + 1) * granularity);
+  }
+  return list.pop();
+}
+
+inline void SharedStatePool::deallocate(void* p, std::size_t n) noexcept {
+  if (n > max_size) {
+    ::operator delete(p, n);
+    return;
+  }
+  const auto c = size_class(n);
+  auto& list = local().lists_[c];
+  list.push(static_cast<Block*>(p));
+  if (list.size_ > 2 * batch_size) {
+    auto& d = depot();
+    auto lock = std::scoped_lock{d.mutex_};
+    list.move_to(d.lists_[c], batch_size);
+  }
+}
+
+template <typename T>
+class Future;
+template <typename T>
+class Promise;
+
+namespace future_detail {
+
+class StateBase {
+public:
+  explicit StateBase(Executor* executor, int refs) noexcept
+      : executor_{executor}, refs_{refs} {}
+  StateBase(const StateBase&) = delete;
+  StateBase& operator=(const StateBase&) = delete;
+
+  void add_ref() noexcept { refs_.fetch_add(1, std::memory_order_relaxed); }
+  void release() noexcept {
+    if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      destroy_(this);
+    }
+  }
+
+  auto is_ready() const noexcept {
+    return continuation_.load(std::memory_order_acquire) == ready_tag();
+  }
+  // Blocks until the state is ready
+  void wait() noexcept;
+  // Invokes cb, on executor if not null, when the state is ready. At most
+  // one continuation can be attached.
+  void subscribe(Callback& cb, Executor* executor) noexcept;
+
+  void set_exception(std::exception_ptr e) noexcept {
+    exception_ = std::move(e);
+    mark_ready();
+  }
+
+  Executor* executor_{};
+  std::exception_ptr exception_{};
+  void (*destroy_)(StateBase*) noexcept {};
+
+protected:
+  ~StateBase() = default;
+  void mark_ready() noexcept;
+
+private:
+  static void fire(Callback& cb, Executor* executor) noexcept {
+    if (executor != nullptr) {
+      executor->execute(cb);
+    } else {
+      cb();
+    }
+  }
+  // Markers stored in continuation_, only their addresses are used
+  static auto ready_tag() noexcept -> Callback* {
+    static auto tag = Callback{};
+    return &tag;
+  }
+  static auto waiting_tag() noexcept -> Callback* {
+    static auto tag = Callback{};
+    return &tag;
+  }
+
+  std::atomic<int> refs_{};
+  std::atomic<Callback*> continuation_{nullptr};
+  Executor* continuation_executor_{}; // Published by continuation_
+};
+
+inline void StateBase::mark_ready() noexcept {
+  auto* cb = continuation_.exchange(ready_tag(), std::memory_order_acq_rel);
+  if (cb == waiting_tag()) {
+    continuation_.notify_all();
+  } else if (cb != nullptr) {
+    fire(*cb, continuation_executor_);
+  }
+}
+
+inline void StateBase::subscribe(Callback& cb, Executor* executor) noexcept {
+  continuation_executor_ = executor;
+  auto* expected = static_cast<Callback*>(nullptr);
+  if (!continuation_.compare_exchange_strong(expected, &cb,
+                                             std::memory_order_acq_rel,
+                                             std::memory_order_acquire)) {
+    fire(cb, executor); // Already ready
+  }
+}
+
+inline void StateBase::wait() noexcept {
+  auto* expected = static_cast<Callback*>(nullptr);
+  continuation_.compare_exchange_strong(expected, waiting_tag(),
+                                        std::memory_order_acquire);
+  auto* cb = continuation_.load(std::memory_order_acquire);
+  while (cb != ready_tag()) {
+    continuation_.wait(cb, std::memory_order_acquire);
+    cb = continuation_.load(std::memory_order_acquire);
+  }
+}
+
+template <typename T>
+class State : public StateBase {
+public:
+  using StateBase::StateBase;
+
+  template <typename U>
+  void set_value(U&& u) noexcept(std::is_nothrow_constructible_v<T, U&&>) {
+    value_.emplace(std::forward<U>(u));
+    mark_ready();
+  }
+  // Moves the value out, or throws the exception, must be ready
+  auto take() -> T {
+    if (exception_) {
+      std::rethrow_exception(exception_);
+    }
+    return std::move(*value_);
+  }
+
+  std::optional<T> value_{};
+};
+
+template <typename S>
+void destroy_state(StateBase* s) noexcept {
+  auto* state = static_cast<S*>(s);
+  state->~S();
+  SharedStatePool::deallocate(state, sizeof(S));
+}
+
+template <typename S, typename... Args>
+auto make_state(Args&&... args) -> S* {
+  static_assert(alignof(S) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+  auto* p = SharedStatePool::allocate(sizeof(S));
+  try {
+    auto* s = new (p) S(std::forward<Args>(args)...);
+    s->destroy_ = &destroy_state<S>;
+    return s;
+  } catch (...) {
+    SharedStatePool::deallocate(p, sizeof(S));
+    throw;
+  }
+}
+
+// The state of the future returned by then(), which is also the
+// continuation of the parent state
+template <typename T, typename F>
+class ThenState : public State<std::invoke_result_t<F, T>>, public Callback {
+  using R = std::invoke_result_t<F, T>;
+
+public:
+  // One reference for the returned future and one for the continuation
+  ThenState(State<T>* parent, F f, Executor* executor)
+      : State<R>{executor, 2}, Callback{&run}, parent_{parent},
+        f_{std::move(f)} {}
+
+private:
+  static void run(Callback* cb) noexcept {
+    auto* self = static_cast<ThenState*>(cb);
+    auto* parent = self->parent_;
+    if (parent->exception_) {
+      self->set_exception(parent->exception_);
+    } else {
+      try {
+        self->set_value(std::invoke(self->f_, std::move(*parent->value_)));
+      } catch (...) {
+        self->set_exception(std::current_exception());
+      }
+    }
+    parent->release();
+    self->release();
+  }
+
+  State<T>* parent_{};
+  F f_;
+};
+
+template <typename T>
+class WhenAllState : public State<std::vector<T>> {
+  struct Input : Callback {
+    WhenAllState* owner_{};
+    State<T>* state_{};
+    std::size_t index_{};
+  };
+
+public:
+  // One reference for the returned future and one per input
+  WhenAllState(std::vector<State<T>*> inputs, Executor* executor)
+      : State<std::vector<T>>{executor, static_cast<int>(inputs.size()) + 1},
+        inputs_(inputs.size()), results_(inputs.size()),
+        remaining_{inputs.size()} {
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+      inputs_[i].invoke_ = &on_ready;
+      inputs_[i].owner_ = this;
+      inputs_[i].state_ = inputs[i];
+      inputs_[i].index_ = i;
+    }
+  }
+  void subscribe_all() noexcept {
+    if (inputs_.empty()) {
+      this->set_value(std::vector<T>{});
+    }
+    for (auto& input : inputs_) {
+      input.state_->subscribe(input, nullptr);
+    }
+  }
+
+private:
+  static void on_ready(Callback* cb) noexcept {
+    auto& input = *static_cast<Input*>(cb);
+    auto* self = input.owner_;
+    if (input.state_->exception_) {
+      if (!self->failed_.exchange(true, std::memory_order_relaxed)) {
+        self->set_exception(input.state_->exception_);
+      }
+    } else {
+      self->results_[input.index_] = std::move(*input.state_->value_);
+    }
+    input.state_->release();
+    if (self->remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1 &&
+        !self->failed_.load(std::memory_order_relaxed)) {
+      try {
+        auto values = std::vector<T>{};
+        values.reserve(self->results_.size());
+        for (auto& r : self->results_) {
+          values.push_back(std::move(*r));
+        }
+        self->set_value(std::move(values));
+      } catch (...) {
+        self->set_exception(std::current_exception());
+      }
+    }
+    self->release();
+  }
+
+  std::vector<Input> inputs_;
+  std::vector<std::optional<T>> results_;
+  std::atomic<std::size_t> remaining_{};
+  std::atomic<bool> failed_{false};
+};
+
+template <typename T>
+class WhenAnyState : public State<std::pair<std::size_t, T>> {
+  struct Input : Callback {
+    WhenAnyState* owner_{};
+    State<T>* state_{};
+    std::size_t index_{};
+  };
+
+public:
+  WhenAnyState(std::vector<State<T>*> inputs, Executor* executor)
+      : State<std::pair<std::size_t, T>>{executor,
+                                         static_cast<int>(inputs.size()) + 1},
+        inputs_(inputs.size()) {
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+      inputs_[i].invoke_ = &on_ready;
+      inputs_[i].owner_ = this;
+      inputs_[i].state_ = inputs[i];
+      inputs_[i].index_ = i;
+    }
+  }
+  void subscribe_all() noexcept {
+    for (auto& input : inputs_) {
+      input.state_->subscribe(input, nullptr);
+    }
+  }
+
+private:
+  static void on_ready(Callback* cb) noexcept {
+    auto& input = *static_cast<Input*>(cb);
+    auto* self = input.owner_;
+    // The first input to finish decides the result
+    if (!self->done_.exchange(true, std::memory_order_relaxed)) {
+      if (input.state_->exception_) {
+        self->set_exception(input.state_->exception_);
+      } else {
+        try {
+          self->set_value(std::pair<std::size_t, T>{
+              input.index_, std::move(*input.state_->value_)});
+        } catch (...) {
+          self->set_exception(std::current_exception());
+        }
+      }
+    }
+    input.state_->release();
+    self->release();
+  }
+
+  std::vector<Input> inputs_;
+  std::atomic<bool> done_{false};
+};
+
+} // namespace future_detail
+
+template <typename T>
+class Future {
+  static_assert(!std::is_void_v<T> && !std::is_reference_v<T>);
+
+public:
+  Future() noexcept = default;
+  Future(Future&& other) noexcept
+      : state_{std::exchange(other.state_, nullptr)} {}
+  Future& operator=(Future&& other) noexcept {
+    if (this != &other) {
+      reset();
+      state_ = std::exchange(other.state_, nullptr);
+    }
+    return *this;
+  }
+  ~Future() { reset(); }
+
+  auto valid() const noexcept { return state_ != nullptr; }
+  auto is_ready() const noexcept { return state_->is_ready(); }
+
+  // Blocks until the value is set and returns it, the future is no longer
+  // valid afterwards
+  auto get() -> T {
+    state_->wait();
+    auto state = Future{std::move(*this)}; // Released when leaving
+    return state.state_->take();
+  }
+
+  // Calls f(T) when the value is set and returns a future to its result.
+  // The future is no longer valid afterwards. f runs on the executor of
+  // this future, or on executor.
+  template <typename F>
+  auto then(F f) -> Future<std::invoke_result_t<F, T>> {
+    return then(*state_->executor_, std::move(f));
+  }
+  template <typename F>
+  auto then(Executor& executor, F f) -> Future<std::invoke_result_t<F, T>> {
+    using S = future_detail::ThenState<T, F>;
+    auto* next = future_detail::make_state<S>(state_, std::move(f), &executor);
+    std::exchange(state_, nullptr)->subscribe(*next, &executor);
+    return Future<std::invoke_result_t<F, T>>{next};
+  }
+
+private:
+  template <typename U>
+  friend class Future;
+  friend class Promise<T>;
+  template <typename U>
+  friend auto when_all(std::vector<Future<U>> futures)
+      -> Future<std::vector<U>>;
+  template <typename U>
+  friend auto when_any(std::vector<Future<U>> futures)
+      -> Future<std::pair<std::size_t, U>>;
+
+  explicit Future(future_detail::State<T>* state) noexcept : state_{state} {}
+  void reset() noexcept {
+    if (state_ != nullptr) {
+      std::exchange(state_, nullptr)->release();
+    }
+  }
+
+  future_detail::State<T>* state_{};
+};
+
+template <typename T>
+class Promise {
+public:
+  explicit Promise(Executor& executor = InlineExecutor::instance())
+      : state_{future_detail::make_state<future_detail::State<T>>(&executor,
+                                                                 1)} {}
+  Promise(Promise&& other) noexcept
+      : state_{std::exchange(other.state_, nullptr)},
+        satisfied_{other.satisfied_} {}
+  Promise& operator=(Promise&&) = delete;
+  ~Promise() {
+    if (state_ != nullptr) {
+      if (!satisfied_) {
+        state_->set_exception(std::make_exception_ptr(
+            std::future_error{std::future_errc::broken_promise}));
+      }
+      state_->release();
+    }
+  }
+
+  // May only be called once
+  auto get_future() -> Future<T> {
+    state_->add_ref();
+    return Future<T>{state_};
+  }
+  template <typename U = T>
+  void set_value(U&& u) {
+    state_->set_value(std::forward<U>(u));
+    satisfied_ = true;
+  }
+  void set_exception(std::exception_ptr e) {
+    state_->set_exception(std::move(e));
+    satisfied_ = true;
+  }
+
+private:
+  future_detail::State<T>* state_{};
+  bool satisfied_{false};
+};
+
+// A future to all the values, or to the first exception. The
+// continuations of the combined future run on the executor of the first
+// input.
+template <typename T>
+auto when_all(std::vector<Future<T>> futures) -> Future<std::vector<T>> {
+  auto* executor = futures.empty() ? &InlineExecutor::instance()
+                                   : futures.front().state_->executor_;
+  auto inputs = std::vector<future_detail::State<T>*>{};
+  for (auto& f : futures) {
+    inputs.push_back(f.state_);
+  }
+  using S = future_detail::WhenAllState<T>;
+  auto* state = future_detail::make_state<S>(inputs, executor);
+  for (auto& f : futures) {
+    f.state_ = nullptr; // The references are moved to state
+  }
+  state->subscribe_all();
+  return Future<std::vector<T>>{state};
+}
+
+// A future to the index and value of the first input that is set, futures
+// must not be empty
+template <typename T>
+auto when_any(std::vector<Future<T>> futures)
+    -> Future<std::pair<std::size_t, T>> {
+  assert(!futures.empty());
+  auto* executor = futures.empty() ? &InlineExecutor::instance()
+                                   : futures.front().state_->executor_;
+  auto inputs = std::vector<future_detail::State<T>*>{};
+  for (auto& f : futures) {
+    inputs.push_back(f.state_);
+  }
+  using S = future_detail::WhenAnyState<T>;
+  auto* state = future_detail::make_state<S>(inputs, executor);
+  for (auto& f : futures) {
+    f.state_ = nullptr;
+  }
+  state->subscribe_all();
+  return Future<std::pair<std::size_t, T>>{state};
+}
@@ -1,8 +1,14 @@
 #include <gtest/gtest.h>
 
+#include "per_thread.h"
+#include "sharded_counter.h"
+
 #include <atomic>
 #include <cassert>
+#include <cstdint>
+#include <functional>
 #include <iostream>
+#include <numeric>
 #include <thread>
 
 namespace {
@@ -15,6 +21,19 @@ auto increment_counter(int n) {
   }
 }
 
+// Each thread counts in a slot of its own, which are summed at the end
+auto increment_local_counter(int n, int& local_counter) {
+  for (int i = 0; i < n; i++) {
+    ++local_counter;
+  }
+}
+
+auto increment_sharded_counter(int n, ShardedCounter& sharded_counter) {
+  for (int i = 0; i < n; i++) {
+    ++sharded_counter;
+  }
+}
+
 } // namespace
 
 TEST(CounterAtomic, IncrementCounter) {
@@ -29,3 +48,55 @@ TEST(CounterAtomic, IncrementCounter) {
   // If we don't have a data race, this assert should hold:
   ASSERT_EQ(n_times * 2, counter);
 }
+
+TEST(CounterAtomic, IncrementPerThreadCounters) {
+  const int n_times = 1000000;
+  auto counters = PerThread<int>{2};
+  std::thread t1(increment_local_counter, n_times, std::ref(counters[0]));
+  std::thread t2(increment_local_counter, n_times, std::ref(counters[1]));
+
+  t1.join();
+  t2.join();
+  const auto sum = counters.combine(0, std::plus<>{});
+  ASSERT_EQ(n_times * 2, sum);
+}
+
+TEST(CounterAtomic, IncrementShardedCounter) {
+  const int n_times = 1000000;
+  auto sharded_counter = ShardedCounter{};
+  std::thread t1(increment_sharded_counter, n_times,
+                 std::ref(sharded_counter));
+  std::thread t2(increment_sharded_counter, n_times,
+                 std::ref(sharded_counter));
+
+  t1.join();
+  t2.join();
+  ASSERT_EQ(n_times * 2, sharded_counter.load());
+}
+
+TEST(CounterAtomic, ShardedCounterResetKeepsEveryIncrement) {
+  const int n_times = 1000000;
+  auto sharded_counter = ShardedCounter{4};
+  ASSERT_EQ(sharded_counter.shard_count(), 4u);
+  std::thread t1(increment_sharded_counter, n_times,
+                 std::ref(sharded_counter));
+  std::thread t2(increment_sharded_counter, n_times,
+                 std::ref(sharded_counter));
+
+  // Collect deltas while the threads are counting
+  auto total = std::int64_t{0};
+  for (int i = 0; i < 100; ++i) {
+    total += sharded_counter.reset();
+  }
+  t1.join();
+  t2.join();
+  total += sharded_counter.reset();
+  ASSERT_EQ(n_times * 2, total);
+  ASSERT_EQ(0, sharded_counter.load());
+
+  sharded_counter.add(5);
+  const auto shards = sharded_counter.snapshot();
+  ASSERT_EQ(shards.size(), 4u);
+  ASSERT_EQ(std::accumulate(shards.begin(), shards.end(), std::int64_t{0}),
+            5);
+}
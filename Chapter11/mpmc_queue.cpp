@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+
+#include "mpmc_queue.h"
+
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(MpmcQueue, TryPushAndTryPop) {
+  auto queue = MpmcQueue<std::string, 4>{};
+  ASSERT_FALSE(queue.try_pop().has_value());
+  for (auto s : {"a", "b", "c", "d"}) {
+    ASSERT_TRUE(queue.try_push(s));
+  }
+  ASSERT_FALSE(queue.try_push("e")); // Full
+  ASSERT_EQ(4, queue.size_approx());
+  ASSERT_EQ("a", *queue.try_pop());
+  ASSERT_TRUE(queue.try_push("e")); // Wraps around
+  for (auto s : {"b", "c", "d", "e"}) {
+    ASSERT_EQ(s, *queue.try_pop());
+  }
+  ASSERT_FALSE(queue.try_pop().has_value());
+}
+
+TEST(MpmcQueue, ManyProducersAndConsumers) {
+  constexpr auto n_threads = 4;
+  constexpr auto n_items = 10000; // Per producer
+  auto queue = MpmcQueue<int, 64>{};
+  auto sums = std::vector<long>(n_threads);
+  {
+    auto threads = std::vector<std::jthread>{};
+    for (auto t = 0; t < n_threads; ++t) {
+      threads.emplace_back([&queue] {
+        for (auto i = 1; i <= n_items; ++i) {
+          queue.push(i);
+        }
+      });
+      threads.emplace_back([&queue, &sum = sums[t]] {
+        for (auto i = 0; i < n_items; ++i) {
+          sum += queue.pop();
+        }
+      });
+    }
+  }
+  const auto total = std::accumulate(sums.begin(), sums.end(), 0L);
+  ASSERT_EQ(n_threads * (n_items * (n_items + 1L) / 2), total);
+  ASSERT_FALSE(queue.try_pop().has_value());
+}
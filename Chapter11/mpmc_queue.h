@@ -0,0 +1,170 @@
+#pragma once
+
+#include "per_thread.h"
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+// Bounded multi-producer multi-consumer queue with a sequence number per
+// slot, as described by Dmitry Vyukov. The sequence number tells whether a
+// slot is ready to be written or read in the current lap around the ring,
+// which means producers and consumers only contend on the slots they are
+// using and on their own position counter.
+//
+// The try_ functions fail when the queue is full or empty. The blocking
+// push() and pop() take a ticket up front and wait for their slot, which
+// gives FIFO order among the blocked threads.
+
+template <typename T, size_t N>
+class MpmcQueue {
+  static_assert(N >= 2 && std::has_single_bit(N), "N must be a power of two");
+  static_assert(std::is_nothrow_move_constructible_v<T>);
+  static constexpr size_t mask = N - 1;
+
+  struct Slot {
+    std::atomic<size_t> sequence_{};
+    alignas(T) std::byte storage_[sizeof(T)];
+    auto value() noexcept {
+      return std::launder(reinterpret_cast<T*>(storage_));
+    }
+  };
+
+public:
+  MpmcQueue() noexcept {
+    for (size_t i = 0; i < N; ++i) {
+      slots_[i].sequence_.store(i, std::memory_order_relaxed);
+    }
+  }
+  MpmcQueue(const MpmcQueue&) = delete;
+  MpmcQueue& operator=(const MpmcQueue&) = delete;
+  ~MpmcQueue() {
+    while (try_pop()) {
+    }
+  }
+
+  static constexpr auto capacity() noexcept { return N; }
+
+  auto try_push(T&& t) noexcept { return do_try_push(std::move(t)); }
+  auto try_push(const T& t) { return do_try_push(T(t)); }
+  auto try_pop() noexcept(std::is_nothrow_destructible_v<T>)
+      -> std::optional<T>;
+
+  // Blocks while the queue is full
+  void push(T&& t) noexcept { do_push(std::move(t)); }
+  void push(const T& t) { do_push(T(t)); }
+  // Blocks while the queue is empty
+  auto pop() noexcept(std::is_nothrow_destructible_v<T>) -> T;
+
+  // Only a hint when other threads are using the queue
+  auto size_approx() const noexcept -> size_t {
+    const auto tail = enqueue_pos_.load(std::memory_order_relaxed);
+    const auto head = dequeue_pos_.load(std::memory_order_relaxed);
+    return tail > head ? tail - head : 0;
+  }
+
+private:
+  auto do_try_push(T&& t) noexcept -> bool;
+  void do_push(T&& t) noexcept;
+
+  template <typename Pred>
+  static void spin_until(Pred pred) noexcept {
+    // Spins 64 times before yielding, the counter stops at the limit
+    for (auto i = 0; !pred();) {
+      if (i < 64) {
+        ++i;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  static auto distance(size_t a, size_t b) noexcept {
+    return static_cast<std::intptr_t>(a - b);
+  }
+
+  Slot slots_[N];
+  alignas(cache_line_size) std::atomic<size_t> enqueue_pos_{0};
+  alignas(cache_line_size) std::atomic<size_t> dequeue_pos_{0};
+  static_assert(std::atomic<size_t>::is_always_lock_free);
+};
+
+template <typename T, size_t N>
+auto MpmcQueue<T, N>::do_try_push(T&& t) noexcept -> bool {
+  auto pos = enqueue_pos_.load(std::memory_order_relaxed);
+  for (;;) {
+    auto& slot = slots_[pos & mask];
+    const auto seq = slot.sequence_.load(std::memory_order_acquire);
+    const auto diff = distance(seq, pos);
+    if (diff == 0) {
+      // The slot is free in this lap, try to claim it
+      if (enqueue_pos_.compare_exchange_weak(pos, pos + 1,
+                                             std::memory_order_relaxed)) {
+        std::construct_at(slot.value(), std::move(t));
+        slot.sequence_.store(pos + 1, std::memory_order_release);
+        return true;
+      }
+    } else if (diff < 0) {
+      return false; // Full, the slot still holds a value from the last lap
+    } else {
+      pos = enqueue_pos_.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+template <typename T, size_t N>
+auto MpmcQueue<T, N>::try_pop() noexcept(std::is_nothrow_destructible_v<T>)
+    -> std::optional<T> {
+  auto pos = dequeue_pos_.load(std::memory_order_relaxed);
+  for (;;) {
+    auto& slot = slots_[pos & mask];
+    const auto seq = slot.sequence_.load(std::memory_order_acquire);
+    const auto diff = distance(seq, pos + 1);
+    if (diff == 0) {
+      if (dequeue_pos_.compare_exchange_weak(pos, pos + 1,
+                                             std::memory_order_relaxed)) {
+        auto val = std::optional<T>{std::move(*slot.value())};
+        std::destroy_at(slot.value());
+        // Free the slot for the producers of the next lap
+        slot.sequence_.store(pos + N, std::memory_order_release);
+        return val;
+      }
+    } else if (diff < 0) {
+      return std::nullopt; // Empty
+    } else {
+      pos = dequeue_pos_.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+template <typename T, size_t N>
+void MpmcQueue<T, N>::do_push(T&& t) noexcept {
+  const auto pos = enqueue_pos_.fetch_add(1, std::memory_order_relaxed);
+  auto& slot = slots_[pos & mask];
+  spin_until([&] {
+    return slot.sequence_.load(std::memory_order_acquire) == pos;
+  });
+  std::construct_at(slot.value(), std::move(t));
+  slot.sequence_.store(pos + 1, std::memory_order_release);
+}
+
+template <typename T, size_t N>
+auto MpmcQueue<T, N>::pop() noexcept(std::is_nothrow_destructible_v<T>)
+    -> T {
+  const auto pos = dequeue_pos_.fetch_add(1, std::memory_order_relaxed);
+  auto& slot = slots_[pos & mask];
+  spin_until([&] {
+    return slot.sequence_.load(std::memory_order_acquire) == pos + 1;
+  });
+  auto val = T(std::move(*slot.value()));
+  std::destroy_at(slot.value());
+  slot.sequence_.store(pos + N, std::memory_order_release);
+  return val;
+}
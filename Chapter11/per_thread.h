@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Data written by different threads must not share a cache line, or every
+// write invalidates the line in the caches of the other cores, known as
+// false sharing.
+#if defined(__cpp_lib_hardware_interference_size)
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Winterference-size"
+#endif
+inline constexpr auto cache_line_size =
+    std::size_t{std::hardware_destructive_interference_size};
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#else
+inline constexpr auto cache_line_size = std::size_t{64};
+#endif
+
+// A value occupying cache lines of its own
+template <typename T>
+struct alignas(cache_line_size) Padded {
+  T value_{};
+
+  auto& operator*() noexcept { return value_; }
+  auto& operator*() const noexcept { return value_; }
+  auto* operator->() noexcept { return &value_; }
+  auto* operator->() const noexcept { return &value_; }
+};
+
+// One slot per thread, where each thread accumulates into its own slot
+// using plain loads and stores. The slots are merged when the threads are
+// done, instead of having all threads update a shared atomic.
+template <typename T>
+class PerThread {
+public:
+  explicit PerThread(std::size_t n_threads) : slots_(n_threads) {}
+
+  auto size() const noexcept { return slots_.size(); }
+  auto& operator[](std::size_t thread_index) noexcept {
+    return slots_[thread_index].value_;
+  }
+  auto& operator[](std::size_t thread_index) const noexcept {
+    return slots_[thread_index].value_;
+  }
+
+  // Merges the slots using f(T accumulated, const T& slot), the threads
+  // writing to the slots must have been joined
+  template <typename F>
+  auto combine(T init, F f) const {
+    for (const auto& slot : slots_) {
+      init = f(std::move(init), slot.value_);
+    }
+    return init;
+  }
+
+private:
+  std::vector<Padded<T>> slots_;
+};
@@ -0,0 +1,91 @@
+#include <version>
+#if defined(__cpp_lib_barrier)
+
+#include <gtest/gtest.h>
+
+#include "per_thread.h"
+#include "phase_engine.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+TEST(PhaseEngine, Partition) {
+  auto engine = PhaseEngine{3};
+  ASSERT_EQ(engine.partition(10, 0), std::pair(0ul, 4ul));
+  ASSERT_EQ(engine.partition(10, 1), std::pair(4ul, 7ul));
+  ASSERT_EQ(engine.partition(10, 2), std::pair(7ul, 10ul));
+  ASSERT_EQ(engine.partition(2, 2), std::pair(2ul, 2ul)); // Nothing to do
+}
+
+TEST(PhaseEngine, ReduceInCompletion) {
+  auto engine = PhaseEngine{4};
+  auto v = std::vector<int>(1001);
+  std::iota(v.begin(), v.end(), 0);
+  auto partial = PerThread<long>{engine.size()};
+  auto sums = std::vector<long>{};
+
+  auto phase = [&](std::size_t w, std::size_t) {
+    const auto [first, last] = engine.partition(v.size(), w);
+    partial[w] = std::accumulate(v.begin() + first, v.begin() + last, 0l);
+  };
+  auto on_complete = [&](std::size_t) {
+    sums.push_back(partial.combine(0l, std::plus<>{}));
+    std::transform(v.begin(), v.end(), v.begin(), [](int i) { return 2 * i; });
+    return true;
+  };
+  ASSERT_EQ(engine.run(3, phase, on_complete), 3);
+  ASSERT_EQ(sums, (std::vector<long>{500500, 1001000, 2002000}));
+
+  // The same workers are used for the next run
+  sums.clear();
+  ASSERT_EQ(engine.run(1, phase, on_complete), 1);
+  ASSERT_EQ(sums, (std::vector<long>{4004000}));
+}
+
+TEST(PhaseEngine, StopsWhenConverged) {
+  // Steady-state heat in a rod with the ends held at 0 and 1
+  constexpr auto n = 12;
+  auto engine = PhaseEngine{3};
+  auto current = std::vector<double>(n, 0.0);
+  current.back() = 1.0;
+  auto next = current;
+  auto max_change = PerThread<double>{engine.size()};
+
+  auto phases = engine.run(
+      100'000,
+      [&](std::size_t w, std::size_t) {
+        const auto [first, last] = engine.partition(n - 2, w);
+        auto change = 0.0;
+        for (auto i = first + 1; i < last + 1; ++i) {
+          next[i] = (current[i - 1] + current[i + 1]) / 2;
+          change = std::max(change, std::abs(next[i] - current[i]));
+        }
+        max_change[w] = change;
+      },
+      [&](std::size_t) {
+        std::swap(current, next);
+        auto max = [](double a, double b) { return std::max(a, b); };
+        return max_change.combine(0.0, max) > 1e-9;
+      });
+  ASSERT_LT(phases, 100'000);
+  for (auto i = 0; i < n; ++i) {
+    ASSERT_NEAR(current[i], i / (n - 1.0), 1e-6);
+  }
+}
+
+TEST(PhaseEngine, SingleWorker) {
+  auto engine = PhaseEngine{1};
+  auto n_phases = 0;
+  ASSERT_EQ(engine.run(5, [&](std::size_t, std::size_t) { ++n_phases; },
+                       [](std::size_t i) { return i < 1; }),
+            2);
+  ASSERT_EQ(n_phases, 2);
+  ASSERT_EQ(engine.run(0, [](std::size_t, std::size_t) {},
+                       [](std::size_t) { return true; }),
+            0);
+}
+
+#endif // barrier
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <algorithm>
+#include <barrier>
+#include <cstddef>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Bulk-synchronous engine: a fixed set of workers runs a sequence of
+// phases, where every worker processes its own part of the data and then
+// waits at a std::barrier. The completion function of the barrier runs on
+// one thread while the others are blocked, which makes it the place to
+// merge per-worker results and decide if another phase is needed, like
+// check_result() in barriers.cpp.
+//
+// The workers are created once and wait at the same barrier between runs,
+// so iterative algorithms such as stencils don't create threads per step.
+// The thread calling run() takes part as worker 0.
+class PhaseEngine {
+public:
+  explicit PhaseEngine(
+      std::size_t n_workers = std::max(1u, std::thread::hardware_concurrency()))
+      : n_workers_{std::max(std::size_t{1}, n_workers)},
+        barrier_{static_cast<std::ptrdiff_t>(n_workers_), Completion{this}} {
+    threads_.reserve(n_workers_ - 1);
+    for (std::size_t w = 1; w < n_workers_; ++w) {
+      threads_.emplace_back([this, w] { work(w); });
+    }
+  }
+  PhaseEngine(const PhaseEngine&) = delete;
+  PhaseEngine& operator=(const PhaseEngine&) = delete;
+  ~PhaseEngine() {
+    stop_ = true;
+    barrier_.arrive_and_wait(); // Releases the workers from the start gate
+  }
+
+  auto size() const noexcept { return n_workers_; }
+
+  // The part [first, last) of n items that belongs to a worker
+  auto partition(std::size_t n, std::size_t worker) const noexcept {
+    const auto chunk = n / n_workers_;
+    const auto rest = n % n_workers_;
+    const auto first = worker * chunk + std::min(worker, rest);
+    const auto last = first + chunk + (worker < rest ? 1 : 0);
+    return std::pair{first, last};
+  }
+
+  // Runs phase(worker, phase_index) on all workers, followed by
+  // on_complete(phase_index) on one of them. The run ends when on_complete
+  // returns false or after max_phases phases. Returns the number of phases.
+  // Neither function may throw, and only one run can be active at a time.
+  template <typename Phase, typename OnComplete>
+  auto run(std::size_t max_phases, Phase phase, OnComplete on_complete)
+      -> std::size_t;
+
+private:
+  struct Completion {
+    PhaseEngine* engine_{};
+    void operator()() noexcept { engine_->complete(); }
+  };
+
+  void complete() noexcept {
+    if (!running_) { // The start gate of a run
+      running_ = !stop_;
+      return;
+    }
+    const auto more = on_complete_(on_complete_fn_, phase_index_);
+    ++phase_index_;
+    running_ = more && phase_index_ < max_phases_;
+  }
+  void run_phases(std::size_t worker) {
+    while (running_) {
+      phase_(phase_fn_, worker, phase_index_);
+      barrier_.arrive_and_wait();
+    }
+  }
+  void work(std::size_t worker) {
+    for (;;) {
+      barrier_.arrive_and_wait();
+      if (stop_) {
+        return;
+      }
+      run_phases(worker);
+    }
+  }
+
+  std::size_t n_workers_{};
+  // The current run, only written while the workers wait at the barrier
+  void* phase_fn_{};
+  void (*phase_)(void*, std::size_t, std::size_t) noexcept {};
+  void* on_complete_fn_{};
+  bool (*on_complete_)(void*, std::size_t) noexcept {};
+  std::size_t max_phases_{};
+  std::size_t phase_index_{};
+  bool running_{false};
+  bool stop_{false};
+  std::barrier<Completion> barrier_;
+  std::vector<std::jthread> threads_{}; // Joined before barrier_ is destroyed
+};
+
+template <typename Phase, typename OnComplete>
+auto PhaseEngine::run(std::size_t max_phases, Phase phase,
+                      OnComplete on_complete) -> std::size_t {
+  if (max_phases == 0) {
+    return 0;
+  }
+  phase_fn_ = &phase;
+  phase_ = [](void* f, std::size_t worker, std::size_t index) noexcept {
+    (*static_cast<Phase*>(f))(worker, index);
+  };
+  on_complete_fn_ = &on_complete;
+  on_complete_ = [](void* f, std::size_t index) noexcept -> bool {
+    return (*static_cast<OnComplete*>(f))(index);
+  };
+  max_phases_ = max_phases;
+  phase_index_ = 0;
+  barrier_.arrive_and_wait();
+  run_phases(0);
+  return phase_index_;
+}
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+
+#include "rcu_ptr.h"
+
+#include <atomic>
+#include <memory>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Counts the live instances to check that retired snapshots are deleted
+struct Snapshot {
+  Snapshot(std::vector<int> values) : values_{std::move(values)} { ++count; }
+  Snapshot(const Snapshot& other) : values_{other.values_} { ++count; }
+  ~Snapshot() { --count; }
+  std::vector<int> values_;
+  static inline auto count = std::atomic<int>{0};
+};
+
+} // namespace
+
+TEST(RcuPtr, ReadersKeepSnapshotsAlive) {
+  {
+    auto config = RcuPtr<Snapshot>{std::make_unique<Snapshot>(
+        std::vector<int>{1, 2, 3})};
+    {
+      auto reader = config.read();
+      config.update([](Snapshot& s) { s.values_.push_back(4); });
+      // The old snapshot is still in use
+      ASSERT_EQ(reader->values_.size(), 3u);
+      ASSERT_EQ(config.retired_count(), 1u);
+      auto nested = config.read();
+      ASSERT_EQ(nested->values_.size(), 4u);
+    }
+    config.synchronize();
+    ASSERT_EQ(config.retired_count(), 0u);
+    ASSERT_EQ(Snapshot::count, 1);
+    ASSERT_EQ(config.read()->values_.size(), 4u);
+  }
+  ASSERT_EQ(Snapshot::count, 0);
+}
+
+TEST(RcuPtr, ConcurrentReadersAndWriters) {
+  constexpr auto n_updates = 2000;
+  {
+    // The values always sum to zero
+    auto config = RcuPtr<Snapshot>{std::make_unique<Snapshot>(
+        std::vector<int>(16, 0))};
+    auto done = std::atomic<bool>{false};
+    auto readers = std::vector<std::jthread>{};
+    for (auto r = 0; r < 3; ++r) {
+      readers.emplace_back([&] {
+        while (!done) {
+          auto snapshot = config.read();
+          const auto& v = snapshot->values_;
+          ASSERT_EQ(std::accumulate(v.begin(), v.end(), 0), 0);
+        }
+      });
+    }
+    auto writers = std::vector<std::jthread>{};
+    for (auto w = 0; w < 2; ++w) {
+      writers.emplace_back([&config, w] {
+        for (auto i = 0; i < n_updates; ++i) {
+          config.update([i, w](Snapshot& s) {
+            s.values_[i % 16] += 1 + w;
+            s.values_[(i + 1) % 16] -= 1 + w;
+          });
+        }
+      });
+    }
+    writers.clear();
+    done = true;
+    readers.clear();
+    config.synchronize();
+    ASSERT_EQ(Snapshot::count, 1);
+  }
+  ASSERT_EQ(Snapshot::count, 0);
+}
@@ -0,0 +1,220 @@
+#pragma once
+
+#include "per_thread.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Read-copy-update pointer to an immutable object. Readers get the current
+// object without locking, writers publish a new copy and retire the old
+// one. A retired object is deleted when no reader can still be using it,
+// which is tracked with epochs: each reader announces the epoch it started
+// in, in a slot of its own, and writers advance the epoch on every update.
+// An object retired in epoch e is deleted once all active readers started
+// after e.
+//
+// Readers only write to their own padded slot, so reading does not move
+// any shared cache line between the cores. Writers are serialized by a
+// mutex and pay for the copy and the scan of the reader slots.
+
+namespace rcu_detail {
+
+inline constexpr std::size_t max_threads = 256;
+
+// A small index per live thread, reused when the thread exits
+class ThreadIndex {
+public:
+  static auto get() -> std::size_t {
+    static thread_local const auto index = ThreadIndex{};
+    return index.index_;
+  }
+  // All indices handed out so far are below this
+  static auto limit() noexcept -> std::size_t {
+    return high_water().load(std::memory_order_acquire);
+  }
+
+private:
+  ThreadIndex() {
+    auto lock = std::scoped_lock{mutex()};
+    auto& used = in_use();
+    const auto it = std::find(used.begin(), used.end(), false);
+    if (it == used.end()) {
+      throw std::runtime_error{"Too many threads using RcuPtr"};
+    }
+    *it = true;
+    index_ = static_cast<std::size_t>(it - used.begin());
+    if (index_ >= high_water().load(std::memory_order_relaxed)) {
+      high_water().store(index_ + 1, std::memory_order_release);
+    }
+  }
+  ~ThreadIndex() {
+    auto lock = std::scoped_lock{mutex()};
+    in_use()[index_] = false;
+  }
+  ThreadIndex(const ThreadIndex&) = delete;
+  ThreadIndex& operator=(const ThreadIndex&) = delete;
+
+  static auto mutex() -> std::mutex& {
+    static auto m = std::mutex{};
+    return m;
+  }
+  static auto high_water() -> std::atomic<std::size_t>& {
+    static auto n = std::atomic<std::size_t>{0};
+    return n;
+  }
+  static auto in_use() -> std::vector<bool>& {
+    static auto used = std::vector<bool>(max_threads, false);
+    return used;
+  }
+
+  std::size_t index_{};
+};
+
+} // namespace rcu_detail
+
+template <typename T>
+class RcuPtr {
+  // Slot value of a thread that is not reading
+  static constexpr auto not_reading = std::uint64_t{0};
+
+public:
+  // Keeps the object that was current when it was created alive
+  class ReadGuard {
+  public:
+    ReadGuard(const ReadGuard&) = delete;
+    ReadGuard& operator=(const ReadGuard&) = delete;
+    ~ReadGuard() {
+      if (!nested_) {
+        slot_->store(not_reading, std::memory_order_release);
+      }
+    }
+    auto& operator*() const noexcept { return *ptr_; }
+    auto* operator->() const noexcept { return ptr_; }
+    auto* get() const noexcept { return ptr_; }
+
+  private:
+    friend class RcuPtr;
+    ReadGuard(std::atomic<std::uint64_t>* slot, bool nested, const T* ptr)
+        : slot_{slot}, nested_{nested}, ptr_{ptr} {}
+    std::atomic<std::uint64_t>* slot_{};
+    bool nested_{};
+    const T* ptr_{};
+  };
+
+  explicit RcuPtr(std::unique_ptr<const T> initial)
+      : ptr_{initial.release()}, reader_epochs_(rcu_detail::max_threads) {}
+  RcuPtr(const RcuPtr&) = delete;
+  RcuPtr& operator=(const RcuPtr&) = delete;
+  // No reader may be active
+  ~RcuPtr() { delete ptr_.load(std::memory_order_relaxed); }
+
+  auto read() const -> ReadGuard;
+
+  // Publishes next, the old object is deleted when it is no longer read
+  void store(std::unique_ptr<const T> next);
+  // Publishes a modified copy, f is called with a T& to the copy
+  template <typename F>
+  void update(F f);
+  // Waits until all objects retired so far have been deleted, must not be
+  // called while the thread holds a ReadGuard
+  void synchronize();
+
+  auto retired_count() const {
+    auto lock = std::scoped_lock{writer_mutex_};
+    return retired_.size();
+  }
+
+private:
+  struct Retired {
+    std::uint64_t epoch_{};
+    std::unique_ptr<const T> ptr_{};
+  };
+  void publish(std::unique_ptr<const T> next);
+  // Deletes the retired objects that no reader can access, returns true if
+  // all were deleted
+  auto reclaim() -> bool;
+
+  std::atomic<const T*> ptr_{};
+  alignas(cache_line_size) std::atomic<std::uint64_t> epoch_{1};
+  mutable std::vector<Padded<std::atomic<std::uint64_t>>> reader_epochs_;
+  mutable std::mutex writer_mutex_{};
+  std::vector<Retired> retired_{}; // Guarded by writer_mutex_
+};
+
+template <typename T>
+auto RcuPtr<T>::read() const -> ReadGuard {
+  auto& slot = *reader_epochs_[rcu_detail::ThreadIndex::get()];
+  if (slot.load(std::memory_order_relaxed) != not_reading) {
+    // Already protected by an outer guard of this thread
+    return ReadGuard{&slot, true, ptr_.load(std::memory_order_acquire)};
+  }
+  // Acquire pairs with the increment in publish(). If we see the new epoch,
+  // we also see the new pointer.
+  slot.store(epoch_.load(std::memory_order_acquire),
+             std::memory_order_relaxed);
+  // Pairs with the fence in reclaim(). Either the writer sees our epoch,
+  // or we see the pointer that the writer published.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  return ReadGuard{&slot, false, ptr_.load(std::memory_order_acquire)};
+}
+
+template <typename T>
+void RcuPtr<T>::store(std::unique_ptr<const T> next) {
+  auto lock = std::scoped_lock{writer_mutex_};
+  publish(std::move(next));
+}
+
+template <typename T>
+template <typename F>
+void RcuPtr<T>::update(F f) {
+  auto lock = std::scoped_lock{writer_mutex_};
+  // The current object can't be retired while we hold the lock
+  auto copy = std::make_unique<T>(*ptr_.load(std::memory_order_relaxed));
+  f(*copy);
+  publish(std::move(copy));
+}
+
+template <typename T>
+void RcuPtr<T>::publish(std::unique_ptr<const T> next) {
+  auto old = ptr_.exchange(next.release(), std::memory_order_acq_rel);
+  // Readers of the old object announced this epoch or an earlier one
+  const auto epoch = epoch_.fetch_add(1, std::memory_order_release);
+  retired_.push_back(Retired{epoch, std::unique_ptr<const T>{old}});
+  reclaim();
+}
+
+template <typename T>
+auto RcuPtr<T>::reclaim() -> bool {
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  auto oldest_reader = std::numeric_limits<std::uint64_t>::max();
+  const auto n_slots = rcu_detail::ThreadIndex::limit();
+  for (std::size_t i = 0; i < n_slots; ++i) {
+    const auto e = (*reader_epochs_[i]).load(std::memory_order_acquire);
+    if (e != not_reading) {
+      oldest_reader = std::min(oldest_reader, e);
+    }
+  }
+  std::erase_if(retired_, [oldest_reader](const auto& r) {
+    return r.epoch_ < oldest_reader;
+  });
+  return retired_.empty();
+}
+
+template <typename T>
+void RcuPtr<T>::synchronize() {
+  auto lock = std::unique_lock{writer_mutex_};
+  while (!reclaim()) {
+    lock.unlock();
+    std::this_thread::yield();
+    lock.lock();
+  }
+}
@@ -4,61 +4,17 @@
 
 #include <gtest/gtest.h>
 
+#include "bounded_buffer.h"
+
 #include <array>
+#include <atomic>
 #include <iostream>
+#include <mutex>
 #include <optional>
 #include <semaphore>
 #include <string>
 #include <thread>
-
-namespace {
-
-template <class T, int N> class BoundedBuffer {
-  std::array<T, N> buf_;
-  std::size_t read_pos_{};
-  std::size_t write_pos_{};
-  std::mutex m_;
-  std::counting_semaphore<N> n_empty_slots_{N}; // New
-  std::counting_semaphore<N> n_full_slots_{0};  // New
-
-  void do_push(auto&& item) {
-    // Take one of the empty slots (might block)
-    n_empty_slots_.acquire(); // New
-    try {
-      auto lock = std::unique_lock{m_};
-      buf_[write_pos_] = std::forward<decltype(item)>(item);
-      write_pos_ = (write_pos_ + 1) % N;
-    } catch (...) {
-      n_empty_slots_.release();
-      throw;
-    }
-    // Increment and signal that there is one more full slot
-    n_full_slots_.release(); // New
-  }
-
-public:
-  void push(const T& item) { do_push(item); }
-  void push(T&& item) { do_push(std::move(item)); }
-
-  auto pop() {
-    // Take one of the full slots (might block)
-    n_full_slots_.acquire(); // New
-    auto item = std::optional<T>{};
-    try {
-      auto lock = std::unique_lock{m_};
-      item = std::move(buf_[read_pos_]);
-      read_pos_ = (read_pos_ + 1) % N;
-    } catch (...) {
-      n_full_slots_.release();
-      throw;
-    }
-    // Increment and signal that there is one more empty slot
-    n_empty_slots_.release(); // New
-    return std::move(*item);
-  }
-};
-
-} // namespace
+#include <vector>
 
 TEST(Semaphores, BoundedBuffer) {
 
@@ -87,4 +43,29 @@ TEST(Semaphores, BoundedBuffer) {
   consumer.join();
 }
 
+TEST(Semaphores, LockFreeBoundedBuffer) {
+  constexpr auto n_threads = 4;
+  constexpr auto n_items = 1000; // Per producer
+  auto buffer = LockFreeBoundedBuffer<std::string, 5>{};
+  auto counts = std::array<std::atomic<int>, n_items>{};
+  {
+    auto threads = std::vector<std::jthread>{};
+    for (auto t = 0; t < n_threads; ++t) {
+      threads.emplace_back([&buffer] {
+        for (auto i = 0; i < n_items; ++i) {
+          buffer.push(std::to_string(i));
+        }
+      });
+      threads.emplace_back([&buffer, &counts] {
+        for (auto i = 0; i < n_items; ++i) {
+          ++counts[std::stoi(buffer.pop())];
+        }
+      });
+    }
+  }
+  for (const auto& count : counts) {
+    ASSERT_EQ(n_threads, count);
+  }
+}
+
 #endif // semaphore
\ No newline at end of file
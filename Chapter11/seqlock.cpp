@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+
+#include "seqlock.h"
+
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Two balances that always sum to the same total, like the accounts in
+// avoid_deadlock.cpp
+struct Balances {
+  int from_{};
+  int to_{};
+  char note_[20]{}; // Makes the value span several words
+};
+
+} // namespace
+
+TEST(SeqLock, LoadAndStore) {
+  auto seqlock = SeqLock<Balances>{Balances{100, 30}};
+  ASSERT_EQ(seqlock.load().from_, 100);
+  seqlock.store(Balances{1, 2});
+  ASSERT_EQ(seqlock.load().to_, 2);
+  seqlock.modify([](Balances& b) { b.to_ += 10; });
+  ASSERT_EQ(seqlock.load().to_, 12);
+  ASSERT_THROW(seqlock.modify([](Balances&) { throw std::runtime_error{""}; }),
+               std::runtime_error);
+  ASSERT_EQ(seqlock.load().to_, 12); // Still usable
+}
+
+TEST(SeqLock, ReadersNeverSeeTornValues) {
+  constexpr auto n_writes = 20'000;
+  auto seqlock = SeqLock<Balances>{Balances{100, 30}};
+  auto writers = std::vector<std::jthread>{};
+  for (auto w = 0; w < 2; ++w) {
+    writers.emplace_back([&seqlock] {
+      for (auto i = 0; i < n_writes; ++i) {
+        seqlock.modify([i](Balances& b) {
+          b.from_ -= 1;
+          b.to_ += 1;
+          b.note_[i % 20] = static_cast<char>(i);
+        });
+      }
+    });
+  }
+  auto readers = std::vector<std::jthread>{};
+  for (auto r = 0; r < 2; ++r) {
+    readers.emplace_back([&seqlock] {
+      for (auto i = 0; i < n_writes; ++i) {
+        const auto b = seqlock.load();
+        ASSERT_EQ(b.from_ + b.to_, 130);
+      }
+    });
+  }
+  writers.clear();
+  readers.clear();
+  ASSERT_EQ(seqlock.load().to_, 30 + 2 * n_writes);
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "spin_locks.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Sequence lock for small trivially copyable values that are read much more
+// often than they are written. A writer makes the sequence number odd,
+// writes the value and makes the sequence number even again. A reader
+// copies the value and retries if the sequence number was odd or changed
+// in the meantime. Readers only load shared memory, so they never take
+// the cache line away from each other.
+//
+// The value is stored as relaxed atomic words to make the racy copy of a
+// reader well defined; the fences order them with respect to the sequence
+// number, as described by Hans Boehm in "Can Seqlocks Get Along With
+// Programming Language Memory Models?". Writers are serialized by the
+// sequence number itself.
+template <typename T>
+class SeqLock {
+  static_assert(std::is_trivially_copyable_v<T>);
+  static_assert(std::is_default_constructible_v<T>);
+  using Word = std::uint64_t;
+  static constexpr auto n_words = (sizeof(T) + sizeof(Word) - 1) / sizeof(Word);
+
+public:
+  SeqLock() noexcept : SeqLock(T{}) {}
+  explicit SeqLock(const T& value) noexcept { write_words(value); }
+
+  auto load() const noexcept -> T;
+  void store(const T& value) noexcept {
+    modify([&value](T& v) { v = value; });
+  }
+  // Calls f(T&) on the current value and publishes the result, other
+  // writers are held off in the meantime
+  template <typename F>
+  void modify(F f);
+
+private:
+  auto read_words() const noexcept {
+    auto words = std::array<Word, n_words>{};
+    for (std::size_t i = 0; i < n_words; ++i) {
+      words[i] = words_[i].load(std::memory_order_relaxed);
+    }
+    auto value = T{};
+    std::memcpy(static_cast<void*>(&value), words.data(), sizeof(T));
+    return value;
+  }
+  void write_words(const T& value) noexcept {
+    auto words = std::array<Word, n_words>{};
+    std::memcpy(words.data(), &value, sizeof(T));
+    for (std::size_t i = 0; i < n_words; ++i) {
+      words_[i].store(words[i], std::memory_order_relaxed);
+    }
+  }
+
+  std::atomic<std::uint64_t> seq_{0};
+  std::array<std::atomic<Word>, n_words> words_{};
+};
+
+template <typename T>
+auto SeqLock<T>::load() const noexcept -> T {
+  auto backoff = Backoff{};
+  for (;;) {
+    const auto seq = seq_.load(std::memory_order_acquire);
+    if ((seq & 1) == 0) {
+      const auto value = read_words();
+      // Keeps the loads of the value above the second load of seq_
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (seq_.load(std::memory_order_relaxed) == seq) {
+        return value;
+      }
+    }
+    backoff.pause(); // A writer is active
+  }
+}
+
+template <typename T>
+template <typename F>
+void SeqLock<T>::modify(F f) {
+  auto backoff = Backoff{};
+  auto seq = seq_.load(std::memory_order_relaxed);
+  for (;;) {
+    if ((seq & 1) == 0 &&
+        seq_.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire,
+                                   std::memory_order_relaxed)) {
+      break;
+    }
+    backoff.pause();
+    seq = seq_.load(std::memory_order_relaxed);
+  }
+  // Keeps the stores of the value below the odd sequence number
+  std::atomic_thread_fence(std::memory_order_release);
+  // No other writer can be active, the value can be read as is
+  auto value = read_words();
+  try {
+    f(value);
+  } catch (...) {
+    seq_.store(seq + 2, std::memory_order_release); // Nothing was written
+    throw;
+  }
+  write_words(value);
+  seq_.store(seq + 2, std::memory_order_release);
+}
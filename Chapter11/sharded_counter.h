@@ -0,0 +1,83 @@
+#pragma once
+
+#include "per_thread.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+// A counter that can be incremented by many threads at once. Instead of
+// one shared atomic, whose cache line moves between the cores on every
+// increment, the count is split over padded shards. Each thread picks a
+// shard the first time it increments and then only touches that shard
+// with relaxed read-modify-writes. Reading the counter sums the shards.
+//
+// With at least as many shards as hardware threads, threads running at the
+// same time rarely share a shard. Sharing a shard only costs performance
+// since the shards are atomic.
+//
+// The sum is not a snapshot of a single point in time while increments
+// are in flight. Each increment is counted once by load(), and by exactly
+// one call to reset(), which empties each shard with an exchange.
+class ShardedCounter {
+public:
+  explicit ShardedCounter(
+      std::size_t n_shards = std::max(1u, std::thread::hardware_concurrency()))
+      : shards_(std::bit_ceil(std::max(n_shards, std::size_t{1}))),
+        mask_{shards_.size() - 1} {}
+
+  void add(std::int64_t n) noexcept {
+    (*shards_[shard_index() & mask_]).fetch_add(n, std::memory_order_relaxed);
+  }
+  auto& operator++() noexcept {
+    add(1);
+    return *this;
+  }
+
+  // Sum of all shards
+  auto load() const noexcept {
+    auto sum = std::int64_t{0};
+    for (const auto& shard : shards_) {
+      sum += (*shard).load(std::memory_order_relaxed);
+    }
+    return sum;
+  }
+
+  // The value of each shard, for finding hot shards
+  auto snapshot() const {
+    auto values = std::vector<std::int64_t>{};
+    values.reserve(shards_.size());
+    for (const auto& shard : shards_) {
+      values.push_back((*shard).load(std::memory_order_relaxed));
+    }
+    return values;
+  }
+
+  // Sets the counter to zero and returns the count that was removed, which
+  // makes it possible to report deltas without losing increments
+  auto reset() noexcept {
+    auto sum = std::int64_t{0};
+    for (auto& shard : shards_) {
+      sum += (*shard).exchange(0, std::memory_order_relaxed);
+    }
+    return sum;
+  }
+
+  auto shard_count() const noexcept { return shards_.size(); }
+
+private:
+  // Threads are numbered in the order they first use any ShardedCounter
+  static auto shard_index() noexcept -> std::size_t {
+    static auto next_index = std::atomic<std::size_t>{0};
+    static thread_local const auto index =
+        next_index.fetch_add(1, std::memory_order_relaxed);
+    return index;
+  }
+
+  std::vector<Padded<std::atomic<std::int64_t>>> shards_;
+  std::size_t mask_{};
+};
@@ -0,0 +1,77 @@
+#include "spin_locks.h"
+
+#include <gtest/gtest.h>
+
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+template <typename Lock>
+auto count_with(int n_threads, int n) {
+  auto counter = 0; // Counter will be protected by the lock
+  auto counter_mutex = Lock{};
+  auto increment_counter = [&] {
+    for (int i = 0; i < n; ++i) {
+      auto lock = std::scoped_lock{counter_mutex};
+      ++counter;
+    }
+  };
+  auto threads = std::vector<std::jthread>{};
+  for (auto i = 0; i < n_threads; ++i) {
+    threads.emplace_back(increment_counter);
+  }
+  threads.clear();
+  return counter;
+}
+
+template <typename Lock>
+void try_lock_fails_while_locked() {
+  auto m = Lock{};
+  ASSERT_TRUE(m.try_lock());
+  auto t = std::jthread{[&m] { ASSERT_FALSE(m.try_lock()); }};
+  t.join();
+  m.unlock();
+  auto lock = std::unique_lock{m};
+  ASSERT_TRUE(lock.owns_lock());
+}
+
+} // namespace
+
+TEST(SpinLocks, TtasLock) {
+  ASSERT_EQ(count_with<TtasLock>(4, 100'000), 400'000);
+  try_lock_fails_while_locked<TtasLock>();
+}
+
+TEST(SpinLocks, TicketLock) {
+  ASSERT_EQ(count_with<TicketLock>(4, 100'000), 400'000);
+  try_lock_fails_while_locked<TicketLock>();
+}
+
+TEST(SpinLocks, McsLock) {
+  ASSERT_EQ(count_with<McsLock>(4, 100'000), 400'000);
+  try_lock_fails_while_locked<McsLock>();
+}
+
+TEST(SpinLocks, McsLockHoldingSeveralLocks) {
+  auto a = McsLock{};
+  auto b = McsLock{};
+  auto counter = 0;
+  auto increment_counter = [&] {
+    for (int i = 0; i < 10'000; ++i) {
+      auto lock = std::scoped_lock{a, b};
+      ++counter;
+    }
+  };
+  auto t1 = std::jthread{increment_counter};
+  auto t2 = std::jthread{increment_counter};
+  t1.join();
+  t2.join();
+  ASSERT_EQ(counter, 20'000);
+}
+
+TEST(SpinLocks, AdaptiveLock) {
+  ASSERT_EQ(count_with<AdaptiveLock>(4, 100'000), 400'000);
+  try_lock_fails_while_locked<AdaptiveLock>();
+}
@@ -0,0 +1,280 @@
+#pragma once
+
+#include "per_thread.h"
+
+#include <atomic>
+#include <concepts>
+#include <cstdint>
+#include <thread>
+#include <utility>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) ||           \
+    defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+// The named requirement Lockable, which is what std::scoped_lock and
+// std::unique_lock need
+template <typename T>
+concept Lockable = requires(T& m) {
+  m.lock();
+  m.unlock();
+  { m.try_lock() } -> std::convertible_to<bool>;
+};
+
+// Tells the CPU that we are spinning. On x86 this saves power and avoids a
+// pipeline flush from a memory order violation when the spin ends.
+inline void cpu_relax() noexcept {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) ||           \
+    defined(_M_IX86)
+  _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+  asm volatile("yield");
+#endif
+}
+
+// Exponential backoff. Each call pauses twice as long as the previous one,
+// until the limit is reached. From then on the thread yields, which keeps
+// a spinning thread from burning the time slice of the lock holder when
+// there are more threads than cores.
+class Backoff {
+public:
+  void pause() noexcept {
+    if (n_pauses_ <= max_pauses) {
+      for (auto i = 0; i < n_pauses_; ++i) {
+        cpu_relax();
+      }
+      n_pauses_ *= 2;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  void reset() noexcept { n_pauses_ = 1; }
+
+  static constexpr int max_pauses = 64;
+
+private:
+  int n_pauses_{1};
+};
+
+// Test and test-and-set lock with exponential backoff. Like the SimpleMutex
+// in atomics.cpp it spins on a load, but it also backs off after losing a
+// race, so that not every waiter attempts the exchange as soon as the lock
+// is released.
+class TtasLock {
+public:
+  void lock() noexcept {
+    auto backoff = Backoff{};
+    for (;;) {
+      if (!locked_.exchange(true, std::memory_order_acquire)) {
+        return;
+      }
+      while (locked_.load(std::memory_order_relaxed)) {
+        backoff.pause();
+      }
+    }
+  }
+  bool try_lock() noexcept {
+    return !locked_.load(std::memory_order_relaxed) &&
+           !locked_.exchange(true, std::memory_order_acquire);
+  }
+  void unlock() noexcept { locked_.store(false, std::memory_order_release); }
+
+private:
+  std::atomic<bool> locked_{false};
+};
+
+// Ticket lock, which grants the lock in FIFO order. A waiter knows how many
+// threads are ahead of it and pauses in proportion to that. All waiters
+// still read the same now_serving_ counter, so every release invalidates
+// the cache line in the cache of every waiter.
+class TicketLock {
+public:
+  void lock() noexcept {
+    const auto ticket = next_ticket_.fetch_add(1, std::memory_order_relaxed);
+    auto n_spins = 0;
+    for (;;) {
+      const auto serving = now_serving_.load(std::memory_order_acquire);
+      if (serving == ticket) {
+        return;
+      }
+      if (++n_spins > max_spins) {
+        // The holder or the thread next in line might not be running
+        std::this_thread::yield();
+        continue;
+      }
+      for (auto i = (ticket - serving) * pauses_per_waiter; i > 0; --i) {
+        cpu_relax();
+      }
+    }
+  }
+  bool try_lock() noexcept {
+    auto ticket = now_serving_.load(std::memory_order_relaxed);
+    return next_ticket_.compare_exchange_strong(ticket, ticket + 1,
+                                                std::memory_order_acquire,
+                                                std::memory_order_relaxed);
+  }
+  void unlock() noexcept {
+    const auto serving = now_serving_.load(std::memory_order_relaxed);
+    now_serving_.store(serving + 1, std::memory_order_release);
+  }
+
+  static constexpr std::uint32_t pauses_per_waiter = 16;
+  static constexpr int max_spins = 16;
+
+private:
+  alignas(cache_line_size) std::atomic<std::uint32_t> next_ticket_{0};
+  alignas(cache_line_size) std::atomic<std::uint32_t> now_serving_{0};
+};
+
+// MCS queue lock by Mellor-Crummey and Scott. The waiters form a linked
+// list and each waiter spins on a flag in its own node, which the previous
+// holder clears on release. Only one waiter is disturbed per release, no
+// matter how many threads are waiting.
+//
+// The classic interface passes the node to lock() and unlock(). To satisfy
+// Lockable, the nodes are instead taken from a per-thread cache and the
+// node of the current holder is stored in the lock. A node is safe to reuse
+// as soon as unlock() has returned.
+class McsLock {
+  struct alignas(cache_line_size) Node {
+    std::atomic<Node*> next_{nullptr};
+    std::atomic<bool> locked_{false};
+  };
+
+public:
+  // May throw std::bad_alloc when the thread needs a new node
+  void lock() {
+    auto* node = acquire_node();
+    const auto prev = tail_.exchange(node, std::memory_order_acq_rel);
+    if (prev != nullptr) {
+      node->locked_.store(true, std::memory_order_relaxed);
+      prev->next_.store(node, std::memory_order_release);
+      auto backoff = Backoff{};
+      while (node->locked_.load(std::memory_order_acquire)) {
+        backoff.pause();
+      }
+    }
+    holder_ = node;
+  }
+  bool try_lock() {
+    auto* node = acquire_node();
+    auto* expected = static_cast<Node*>(nullptr);
+    if (tail_.compare_exchange_strong(expected, node,
+                                      std::memory_order_acquire,
+                                      std::memory_order_relaxed)) {
+      holder_ = node;
+      return true;
+    }
+    release_node(node);
+    return false;
+  }
+  void unlock() noexcept {
+    auto* node = holder_;
+    auto* next = node->next_.load(std::memory_order_acquire);
+    if (next == nullptr) {
+      auto* expected = node;
+      if (tail_.compare_exchange_strong(expected, nullptr,
+                                        std::memory_order_release,
+                                        std::memory_order_relaxed)) {
+        release_node(node);
+        return;
+      }
+      // A thread has swapped itself into the tail but has not linked its
+      // node to ours yet
+      while ((next = node->next_.load(std::memory_order_acquire)) ==
+             nullptr) {
+        cpu_relax();
+      }
+    }
+    next->locked_.store(false, std::memory_order_release);
+    release_node(node);
+  }
+
+private:
+  // Free nodes of the calling thread, a thread needs one per lock it
+  // holds. The nodes are linked through next_, so that unlock() never
+  // allocates.
+  struct NodeCache {
+    Node* head_{nullptr};
+    NodeCache() = default;
+    NodeCache(const NodeCache&) = delete;
+    NodeCache& operator=(const NodeCache&) = delete;
+    ~NodeCache() {
+      while (head_ != nullptr) {
+        auto* next = head_->next_.load(std::memory_order_relaxed);
+        delete std::exchange(head_, next);
+      }
+    }
+  };
+  static auto node_cache() noexcept -> NodeCache& {
+    static thread_local auto nodes = NodeCache{};
+    return nodes;
+  }
+  static auto acquire_node() -> Node* {
+    auto& nodes = node_cache();
+    if (nodes.head_ == nullptr) {
+      return new Node{};
+    }
+    auto* node = nodes.head_;
+    nodes.head_ = node->next_.load(std::memory_order_relaxed);
+    node->next_.store(nullptr, std::memory_order_relaxed);
+    return node;
+  }
+  static void release_node(Node* node) noexcept {
+    auto& nodes = node_cache();
+    node->next_.store(nodes.head_, std::memory_order_relaxed);
+    nodes.head_ = node;
+  }
+
+  alignas(cache_line_size) std::atomic<Node*> tail_{nullptr};
+  Node* holder_{nullptr}; // Only accessed by the thread holding the lock
+};
+
+// Spins with backoff for a short while, then parks the thread with
+// std::atomic::wait() like the second SimpleMutex in atomics.cpp. The state
+// tells whether anybody might be parked, which is what keeps unlock() from
+// making a notify call when the lock is only contended briefly.
+class AdaptiveLock {
+  enum State : std::uint32_t { Unlocked, Locked, LockedWithWaiters };
+
+public:
+  void lock() noexcept {
+    auto backoff = Backoff{};
+    for (auto i = 0; i < spin_count; ++i) {
+      if (try_lock()) {
+        return;
+      }
+      backoff.pause();
+    }
+    // Announce that we are about to park. Whoever gets the lock from here
+    // on will notify on unlock, even if it cannot know if anybody is left.
+    while (state_.exchange(LockedWithWaiters, std::memory_order_acquire) !=
+           Unlocked) {
+      state_.wait(LockedWithWaiters, std::memory_order_relaxed);
+    }
+  }
+  bool try_lock() noexcept {
+    auto expected = std::uint32_t{Unlocked};
+    return state_.load(std::memory_order_relaxed) == Unlocked &&
+           state_.compare_exchange_strong(expected, Locked,
+                                          std::memory_order_acquire,
+                                          std::memory_order_relaxed);
+  }
+  void unlock() noexcept {
+    if (state_.exchange(Unlocked, std::memory_order_release) ==
+        LockedWithWaiters) {
+      state_.notify_one();
+    }
+  }
+
+  static constexpr int spin_count = 16;
+
+private:
+  std::atomic<std::uint32_t> state_{Unlocked};
+};
+
+static_assert(Lockable<TtasLock>);
+static_assert(Lockable<TicketLock>);
+static_assert(Lockable<McsLock>);
+static_assert(Lockable<AdaptiveLock>);
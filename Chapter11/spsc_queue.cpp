@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+
+#include "spsc_queue.h"
+
+#include <array>
+#include <chrono>
+#include <numeric>
+#include <optional>
+#include <thread>
+#include <vector>
+
+TEST(SpscQueue, PushAndPop) {
+  auto queue = SpscQueue<int, 4>{};
+  ASSERT_FALSE(queue.pop().has_value());
+  for (auto i = 0; i < 4; ++i) {
+    ASSERT_TRUE(queue.push(i));
+  }
+  ASSERT_FALSE(queue.push(4)); // Full
+  ASSERT_EQ(0, *queue.pop());
+  ASSERT_TRUE(queue.push(4)); // Wraps around
+  for (auto i = 1; i <= 4; ++i) {
+    ASSERT_EQ(i, *queue.pop());
+  }
+  ASSERT_EQ(0, queue.size());
+}
+
+TEST(SpscQueue, PushAndPopMany) {
+  auto queue = SpscQueue<int, 8>{};
+  auto in = std::array<int, 6>{1, 2, 3, 4, 5, 6};
+  auto out = std::array<int, 6>{};
+  ASSERT_EQ(6, queue.push_n(in));
+  ASSERT_EQ(2, queue.push_n(in)); // Only room for two more
+  ASSERT_EQ(6, queue.pop_n(out));
+  ASSERT_EQ(in, out);
+  ASSERT_EQ(6, queue.push_n(in)); // Wraps around
+  ASSERT_EQ(6, queue.pop_n(out));
+  ASSERT_EQ((std::array{1, 2, 1, 2, 3, 4}), out);
+  ASSERT_EQ(2, queue.pop_n(out));
+  ASSERT_EQ(5, out[0]);
+  ASSERT_EQ(6, out[1]);
+}
+
+TEST(SpscQueue, BatchesBetweenThreads) {
+  constexpr auto n = 100000;
+  auto queue = SpscQueue<int, 64>{};
+  auto result = std::vector<int>{};
+  auto writer = std::jthread{[&queue] {
+    auto batch = std::array<int, 16>{};
+    for (auto i = 0; i < n;) {
+      std::iota(batch.begin(), batch.end(), i);
+      const auto count = std::min<size_t>(batch.size(), n - i);
+      if (const auto pushed = queue.push_n({batch.data(), count}); pushed) {
+        i += pushed;
+      } else {
+        std::this_thread::yield(); // Full
+      }
+    }
+  }};
+  auto batch = std::array<int, 16>{};
+  while (result.size() < n) {
+    const auto count = queue.pop_n(batch);
+    result.insert(result.end(), batch.begin(), batch.begin() + count);
+    if (count == 0) {
+      std::this_thread::yield(); // Empty
+    }
+  }
+  auto expected = std::vector<int>(n);
+  std::iota(expected.begin(), expected.end(), 0);
+  ASSERT_EQ(expected, result);
+}
+
+// Like LockFreeQueue.PutAndPop, but the reader is parked instead of busy
+// waiting while the queue is empty
+TEST(SpscQueue, BlockingPutAndPop) {
+  auto queue = SpscQueue<std::optional<int>, 4>{};
+  auto result = std::vector<int>{};
+
+  auto writer = std::jthread{[&queue] {
+    for (auto i = 0; i < 1000; ++i) {
+      queue.push_wait(i);
+      if (i % 100 == 0) {
+        // Give the reader time to park
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+      }
+    }
+    queue.push_wait(std::nullopt);
+  }};
+
+  while (auto element = queue.pop_wait()) {
+    result.push_back(*element);
+  }
+  writer.join();
+
+  auto expected = std::vector<int>(1000);
+  std::iota(expected.begin(), expected.end(), 0);
+  ASSERT_EQ(expected, result);
+}
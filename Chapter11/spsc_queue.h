@@ -0,0 +1,215 @@
+#pragma once
+
+#include "per_thread.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <utility>
+
+// Single-producer single-consumer queue, a faster variant of LockFreeQueue.
+// Instead of a shared size counter updated with sequentially consistent
+// read-modify-writes, each side owns its position and publishes it with a
+// release store. Each side also keeps a cached copy of the other side's
+// position and only reloads it when the queue looks full or empty, which
+// keeps the cache line of the other side from bouncing on every element.
+// The positions are never wrapped, indices are computed by masking.
+//
+// push_wait() and pop_wait() block instead of failing. They spin for a
+// while and then park the thread with std::atomic::wait() on the position
+// of the other side. The other side only calls notify_one() if it sees
+// that the peer is parked, so the blocking calls cost a fence each but no
+// system call while both threads are busy. A parked thread is only woken
+// by the blocking functions of the other side, so a queue should use
+// either the blocking or the non-blocking functions.
+
+template <class T, size_t N>
+class SpscQueue {
+  static_assert(N >= 2 && std::has_single_bit(N), "N must be a power of two");
+  static constexpr size_t mask = N - 1;
+
+public:
+  // Writer thread
+  bool push(T&& t) { return do_push(std::move(t)); }
+  bool push(const T& t) { return do_push(t); }
+  // Copies as many elements as there is room for, returns the number of
+  // elements pushed
+  auto push_n(std::span<const T> items) -> size_t;
+  // Blocks while the queue is full
+  void push_wait(T&& t) { do_push_wait(std::move(t)); }
+  void push_wait(const T& t) { do_push_wait(t); }
+
+  // Reader thread
+  auto pop() -> std::optional<T>;
+  // Moves up to out.size() elements to out, returns the number of elements
+  // popped
+  auto pop_n(std::span<T> out) -> size_t;
+  // Blocks while the queue is empty
+  auto pop_wait() -> T;
+
+  // Approximate when used by both threads
+  auto size() const noexcept {
+    return write_pos_.load(std::memory_order_acquire) -
+           read_pos_.load(std::memory_order_acquire);
+  }
+  static constexpr auto capacity() noexcept { return N; }
+
+  static constexpr int spin_count = 1024;
+
+private:
+  template <typename U>
+  bool do_push(U&& u);
+  template <typename U>
+  void do_push_wait(U&& u);
+  // Waits until pred() holds, parking the thread on pos when spinning did
+  // not help
+  template <typename Pred>
+  static void wait_for(Pred pred, std::atomic<size_t>& pos,
+                       std::atomic<bool>& parked);
+  // Wakes the peer if it is parked on pos
+  static void notify(std::atomic<size_t>& pos, std::atomic<bool>& parked);
+  // Free slots as seen by the writer, reloads the read position if fewer
+  // than n slots seem to be free
+  auto free_slots(size_t write_pos, size_t n) -> size_t;
+  // Filled slots as seen by the reader
+  auto filled_slots(size_t read_pos, size_t n) -> size_t;
+
+  std::array<T, N> buffer_{};
+  alignas(cache_line_size) std::atomic<size_t> write_pos_{0};
+  size_t cached_read_pos_{0}; // Used by writer thread
+  alignas(cache_line_size) std::atomic<size_t> read_pos_{0};
+  size_t cached_write_pos_{0}; // Used by reader thread
+  // The parked flags are read by the peer in notify() after every push and
+  // pop, so they don't share a cache line with the positions
+  alignas(cache_line_size) std::atomic<bool> writer_parked_{false};
+  alignas(cache_line_size) std::atomic<bool> reader_parked_{false};
+  static_assert(std::atomic<size_t>::is_always_lock_free);
+};
+
+template <class T, size_t N>
+auto SpscQueue<T, N>::free_slots(size_t write_pos, size_t n) -> size_t {
+  auto free = N - (write_pos - cached_read_pos_);
+  if (free < n) {
+    cached_read_pos_ = read_pos_.load(std::memory_order_acquire);
+    free = N - (write_pos - cached_read_pos_);
+  }
+  return free;
+}
+
+template <class T, size_t N>
+auto SpscQueue<T, N>::filled_slots(size_t read_pos, size_t n) -> size_t {
+  auto filled = cached_write_pos_ - read_pos;
+  if (filled < n) {
+    cached_write_pos_ = write_pos_.load(std::memory_order_acquire);
+    filled = cached_write_pos_ - read_pos;
+  }
+  return filled;
+}
+
+template <class T, size_t N>
+template <typename U>
+bool SpscQueue<T, N>::do_push(U&& u) {
+  const auto w = write_pos_.load(std::memory_order_relaxed);
+  if (free_slots(w, 1) == 0) {
+    return false;
+  }
+  buffer_[w & mask] = std::forward<U>(u);
+  write_pos_.store(w + 1, std::memory_order_release);
+  return true;
+}
+
+template <class T, size_t N>
+auto SpscQueue<T, N>::push_n(std::span<const T> items) -> size_t {
+  const auto w = write_pos_.load(std::memory_order_relaxed);
+  const auto n = std::min(items.size(), free_slots(w, items.size()));
+  // Copy in at most two parts, the second one after wrapping around
+  const auto first = std::min(n, N - (w & mask));
+  std::copy_n(items.begin(), first, buffer_.begin() + (w & mask));
+  std::copy_n(items.begin() + first, n - first, buffer_.begin());
+  write_pos_.store(w + n, std::memory_order_release);
+  return n;
+}
+
+template <class T, size_t N>
+auto SpscQueue<T, N>::pop() -> std::optional<T> {
+  const auto r = read_pos_.load(std::memory_order_relaxed);
+  auto val = std::optional<T>{};
+  if (filled_slots(r, 1) > 0) {
+    val = std::move(buffer_[r & mask]);
+    read_pos_.store(r + 1, std::memory_order_release);
+  }
+  return val;
+}
+
+template <class T, size_t N>
+auto SpscQueue<T, N>::pop_n(std::span<T> out) -> size_t {
+  const auto r = read_pos_.load(std::memory_order_relaxed);
+  const auto n = std::min(out.size(), filled_slots(r, out.size()));
+  const auto first = std::min(n, N - (r & mask));
+  auto it = buffer_.begin() + (r & mask);
+  std::move(it, it + first, out.begin());
+  std::move(buffer_.begin(), buffer_.begin() + (n - first),
+            out.begin() + first);
+  read_pos_.store(r + n, std::memory_order_release);
+  return n;
+}
+
+template <class T, size_t N>
+template <typename Pred>
+void SpscQueue<T, N>::wait_for(Pred pred, std::atomic<size_t>& pos,
+                               std::atomic<bool>& parked) {
+  for (int i = 0; i < spin_count; ++i) {
+    if (pred()) {
+      return;
+    }
+  }
+  while (!pred()) {
+    const auto observed = pos.load(std::memory_order_relaxed);
+    parked.store(true, std::memory_order_relaxed);
+    // Pairs with the fence in notify(). Either the peer sees the parked
+    // flag, or the check below sees the peer's update of pos.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!pred()) {
+      pos.wait(observed, std::memory_order_relaxed);
+    }
+    parked.store(false, std::memory_order_relaxed);
+  }
+}
+
+template <class T, size_t N>
+void SpscQueue<T, N>::notify(std::atomic<size_t>& pos,
+                             std::atomic<bool>& parked) {
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  // Clear the flag to only notify once, the peer might not get to run
+  // before the next update of pos
+  if (parked.load(std::memory_order_relaxed) &&
+      parked.exchange(false, std::memory_order_relaxed)) {
+    pos.notify_one();
+  }
+}
+
+template <class T, size_t N>
+template <typename U>
+void SpscQueue<T, N>::do_push_wait(U&& u) {
+  const auto w = write_pos_.load(std::memory_order_relaxed);
+  wait_for([&] { return free_slots(w, 1) > 0; }, read_pos_,
+           writer_parked_);
+  buffer_[w & mask] = std::forward<U>(u);
+  write_pos_.store(w + 1, std::memory_order_release);
+  notify(write_pos_, reader_parked_);
+}
+
+template <class T, size_t N>
+auto SpscQueue<T, N>::pop_wait() -> T {
+  const auto r = read_pos_.load(std::memory_order_relaxed);
+  wait_for([&] { return filled_slots(r, 1) > 0; }, write_pos_,
+           reader_parked_);
+  auto val = std::move(buffer_[r & mask]);
+  read_pos_.store(r + 1, std::memory_order_release);
+  notify(read_pos_, writer_parked_);
+  return val;
+}
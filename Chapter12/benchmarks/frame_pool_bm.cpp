@@ -0,0 +1,149 @@
+#include "../generator.h"
+// Counts the calls to the global operator new, see Chapter 7
+#include "../../Chapter07/tracked_operator_new.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+//
+// The index compression pipeline from Chapter 12, where vb_encode()
+// creates one nested generator per number. Counts the calls to the global
+// operator new per compressed integer, with and without recycling of the
+// coroutine frames.
+//
+
+namespace {
+
+template <typename Range>
+auto gap_encode(Range& ids) -> Generator<int> {
+  auto last_id = 0;
+  for (auto id : ids) {
+    const auto gap = id - last_id;
+    last_id = id;
+    co_yield gap;
+  }
+}
+
+auto vb_encode_num(int n) -> Generator<std::uint8_t> {
+  for (auto cont = std::uint8_t{0}; cont == 0;) {
+    auto b = static_cast<std::uint8_t>(n % 128);
+    n = n / 128;
+    cont = (n == 0) ? 128 : 0;
+    co_yield(b + cont);
+  }
+}
+
+auto vb_encode_num(std::allocator_arg_t, std::pmr::memory_resource*, int n)
+    -> Generator<std::uint8_t> {
+  for (auto cont = std::uint8_t{0}; cont == 0;) {
+    auto b = static_cast<std::uint8_t>(n % 128);
+    n = n / 128;
+    cont = (n == 0) ? 128 : 0;
+    co_yield(b + cont);
+  }
+}
+
+template <typename Range>
+auto vb_encode(Range& r) -> Generator<std::uint8_t> {
+  for (auto n : r) {
+    auto bytes = vb_encode_num(n);
+    for (auto b : bytes) {
+      co_yield b;
+    }
+  }
+}
+
+// Nested frames are placed in the memory resource
+template <typename Range>
+auto vb_encode(std::allocator_arg_t, std::pmr::memory_resource* mr, Range& r)
+    -> Generator<std::uint8_t> {
+  for (auto n : r) {
+    auto bytes = vb_encode_num(std::allocator_arg, mr, n);
+    for (auto b : bytes) {
+      co_yield b;
+    }
+  }
+}
+
+auto create_ids(size_t n) {
+  auto ids = std::vector<int>(n);
+  auto id = 0;
+  for (auto& i : ids) {
+    id += 1 + (id % 7) * 50; // Gaps of one or two bytes
+    i = id;
+  }
+  return ids;
+}
+
+void report(benchmark::State& state, size_t allocations) {
+  const auto n = static_cast<double>(state.iterations() * state.range(0));
+  state.counters["allocs/int"] = static_cast<double>(allocations) / n;
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename Encode>
+void run(benchmark::State& state, Encode encode) {
+  const auto ids = create_ids(state.range(0));
+  encode(ids); // Warm up the frame pool
+  auto scope = AllocationScope{};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(encode(ids));
+  }
+  report(state, scope.stats().n_allocations);
+}
+
+void bm_compress_global_new(benchmark::State& state) {
+  auto& pool = FramePool::local();
+  const auto max_cached = pool.max_cached();
+  pool.set_max_cached(0); // Every frame goes to operator new
+  run(state, [](const auto& ids) {
+    auto sum = 0;
+    auto gaps = gap_encode(ids);
+    for (auto b : vb_encode(gaps)) {
+      sum += b;
+    }
+    return sum;
+  });
+  pool.set_max_cached(max_cached);
+}
+
+void bm_compress_frame_pool(benchmark::State& state) {
+  run(state, [](const auto& ids) {
+    auto sum = 0;
+    auto gaps = gap_encode(ids);
+    for (auto b : vb_encode(gaps)) {
+      sum += b;
+    }
+    return sum;
+  });
+}
+
+void bm_compress_memory_resource(benchmark::State& state) {
+  // Large enough to hold one frame per number
+  auto buffer = std::vector<std::byte>(state.range(0) * 128);
+  run(state, [&buffer](const auto& ids) {
+    auto mr = std::pmr::monotonic_buffer_resource{
+        buffer.data(), buffer.size(), std::pmr::null_memory_resource()};
+    auto sum = 0;
+    auto gaps = gap_encode(ids);
+    for (auto b : vb_encode(std::allocator_arg, &mr, gaps)) {
+      sum += b;
+    }
+    return sum;
+  });
+}
+
+void CustomArguments(benchmark::internal::Benchmark* b) {
+  b->Arg(10'000)->Unit(benchmark::kMicrosecond);
+}
+
+} // namespace
+
+BENCHMARK(bm_compress_global_new)->Apply(CustomArguments);
+BENCHMARK(bm_compress_frame_pool)->Apply(CustomArguments);
+BENCHMARK(bm_compress_memory_resource)->Apply(CustomArguments);
+
+BENCHMARK_MAIN();
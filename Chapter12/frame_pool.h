@@ -0,0 +1,150 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+
+// Recycles coroutine frames. A coroutine which is created and destroyed
+// over and over again, like a nested generator or an awaited task, gets
+// its frame from a thread local free list instead of from the global
+// operator new.
+//
+// Frames are allocated one by one, which means that a frame freed on
+// another thread than where it was allocated simply ends up in the free
+// list of that thread.
+//
+// The pool of a thread is trivially destructible, so it can still be used
+// while the other thread_local objects are destroyed, for example by a
+// coroutine owned by one of them. When the thread exits, the cached frames
+// are released and frames freed after that go straight to operator delete.
+
+class FramePool {
+public:
+  static constexpr size_t granularity = 64;
+  static constexpr size_t max_frame_size = 1024;
+
+  FramePool(const FramePool&) = delete;
+  FramePool& operator=(const FramePool&) = delete;
+
+  static auto local() noexcept -> FramePool& {
+    thread_local auto pool = FramePool{};
+    thread_local auto reaper = Reaper{pool};
+    return pool;
+  }
+
+  auto allocate(size_t n) -> void*;
+  auto deallocate(void* p, size_t n) noexcept -> void;
+  // Returns all cached frames to the global operator delete
+  auto release() noexcept -> void;
+
+  // The number of free frames kept per size class, 0 turns off recycling
+  auto set_max_cached(size_t n) noexcept {
+    max_cached_ = n;
+    release();
+  }
+  auto max_cached() const noexcept { return max_cached_; }
+  // Frames taken from the global operator new
+  auto upstream_allocations() const noexcept { return upstream_allocations_; }
+
+private:
+  FramePool() noexcept = default;
+
+  struct FreeFrame {
+    FreeFrame* next_{};
+  };
+  // Empties the pool of a thread when the thread exits
+  struct Reaper {
+    FramePool& pool_;
+    explicit Reaper(FramePool& pool) noexcept : pool_{pool} {}
+    Reaper(const Reaper&) = delete;
+    Reaper& operator=(const Reaper&) = delete;
+    ~Reaper() { pool_.set_max_cached(0); }
+  };
+  static constexpr size_t n_classes = max_frame_size / granularity;
+  static auto size_class(size_t n) noexcept {
+    return (n + granularity - 1) / granularity - 1;
+  }
+
+  std::array<FreeFrame*, n_classes> free_{};
+  std::array<size_t, n_classes> n_free_{};
+  size_t max_cached_{64};
+  size_t upstream_allocations_{};
+};
+
+static_assert(std::is_trivially_destructible_v<FramePool>);
+
+inline auto FramePool::allocate(size_t n) -> void* {
+  if (n <= max_frame_size) {
+    const auto c = size_class(n);
+    if (auto* f = free_[c]; f != nullptr) {
+      free_[c] = f->next_;
+      --n_free_[c];
+      return f;
+    }
+    n = (c + 1) * granularity;
+  }
+  ++upstream_allocations_;
+  return ::operator new(n);
+}
+
+inline auto FramePool::deallocate(void* p, size_t n) noexcept -> void {
+  if (n <= max_frame_size) {
+    const auto c = size_class(n);
+    if (n_free_[c] < max_cached_) {
+      free_[c] = ::new (p) FreeFrame{free_[c]};
+      ++n_free_[c];
+      return;
+    }
+  }
+  ::operator delete(p);
+}
+
+inline auto FramePool::release() noexcept -> void {
+  for (size_t c = 0; c < n_classes; ++c) {
+    while (auto* f = free_[c]) {
+      free_[c] = f->next_;
+      ::operator delete(f);
+    }
+    n_free_[c] = 0;
+  }
+}
+
+// Base class of a promise type. Frames are taken from the thread local
+// FramePool, unless the coroutine is called with std::allocator_arg and a
+// memory resource as its first two arguments, for example:
+//   auto g = generate(std::allocator_arg, &arena, ...);
+// The resource must outlive the coroutine. Each frame is prefixed with a
+// header holding the resource it came from.
+struct PooledFrame {
+  static auto operator new(size_t n) -> void* {
+    return allocate_frame(n, nullptr);
+  }
+  template <typename... Args>
+  static auto operator new(size_t n, std::allocator_arg_t,
+                           std::pmr::memory_resource* mr, Args&&...)
+      -> void* {
+    return allocate_frame(n, mr);
+  }
+  static auto operator delete(void* p, size_t n) noexcept -> void {
+    auto* header = static_cast<Header*>(p) - 1;
+    if (auto* mr = header->resource_; mr != nullptr) {
+      mr->deallocate(header, n + sizeof(Header));
+    } else {
+      FramePool::local().deallocate(header, n + sizeof(Header));
+    }
+  }
+
+private:
+  struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) Header {
+    std::pmr::memory_resource* resource_{};
+  };
+  static auto allocate_frame(size_t n, std::pmr::memory_resource* mr)
+      -> void* {
+    auto* mem = mr != nullptr ? mr->allocate(n + sizeof(Header))
+                              : FramePool::local().allocate(n + sizeof(Header));
+    return ::new (mem) Header{mr} + 1;
+  }
+};
@@ -0,0 +1,90 @@
+#include "chapter_12.h"
+#ifdef SUPPORTS_COROUTINES
+
+#include <gtest/gtest.h>
+
+#include "generator.h"
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace {
+
+auto iota(int n) -> Generator<int> {
+  for (int i = 0; i < n; ++i) {
+    co_yield i;
+  }
+}
+
+auto iota(std::allocator_arg_t, std::pmr::memory_resource*, int n)
+    -> Generator<int> {
+  for (int i = 0; i < n; ++i) {
+    co_yield i;
+  }
+}
+
+auto sum(Generator<int> g) {
+  auto s = 0;
+  for (auto i : g) {
+    s += i;
+  }
+  return s;
+}
+
+} // namespace
+
+TEST(FramePool, FramesAreRecycled) {
+  auto& pool = FramePool::local();
+  ASSERT_EQ(6, sum(iota(4))); // Warm up the pool
+  const auto before = pool.upstream_allocations();
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_EQ(6, sum(iota(4)));
+  }
+  ASSERT_EQ(before, pool.upstream_allocations());
+}
+
+TEST(FramePool, RecyclingCanBeTurnedOff) {
+  auto& pool = FramePool::local();
+  const auto max_cached = pool.max_cached();
+  pool.set_max_cached(0);
+  const auto before = pool.upstream_allocations();
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_EQ(6, sum(iota(4)));
+  }
+  ASSERT_EQ(before + 10, pool.upstream_allocations());
+  pool.set_max_cached(max_cached);
+}
+
+TEST(FramePool, FramesFromMemoryResource) {
+  auto buffer = std::array<std::byte, 1024>{};
+  auto mr = std::pmr::monotonic_buffer_resource{
+      buffer.data(), buffer.size(), std::pmr::null_memory_resource()};
+  const auto before = FramePool::local().upstream_allocations();
+  ASSERT_EQ(6, sum(iota(std::allocator_arg, &mr, 4)));
+  ASSERT_EQ(before, FramePool::local().upstream_allocations());
+}
+
+TEST(FramePool, FrameFreedAfterThreadExit) {
+  static auto max_cached_at_exit = size_t{1};
+  struct Holder {
+    std::optional<Generator<int>> g_{};
+    ~Holder() {
+      g_.reset(); // Frees the frame after the pool was emptied
+      max_cached_at_exit = FramePool::local().max_cached();
+    }
+  };
+  auto t = std::thread{[] {
+    // Constructed before the pool, hence destroyed after it was emptied
+    thread_local auto holder = Holder{};
+    holder.g_.emplace(iota(3));
+  }};
+  t.join();
+  ASSERT_EQ(0, max_cached_at_exit); // The frame went to operator delete
+}
+
+#endif // SUPPORTS_COROUTINES
@@ -1,6 +1,8 @@
 #include "chapter_12.h"
 #ifdef SUPPORTS_COROUTINES
 
+#include "frame_pool.h"
+
 #include <exception>
 #include <utility>
 
@@ -8,7 +10,7 @@ template <typename T>
 struct Generator {
 
 private:
-  struct Promise {
+  struct Promise : PooledFrame { // Frames are recycled
   T value_;
   auto get_return_object() -> Generator {
     using Handle = std::coroutine_handle<Promise>;
@@ -5,6 +5,8 @@
 
 #include "generator.h"
 
+#include <algorithm>
+
 template <typename T>
 Generator<T> seq() {
   for (T i = {};; ++i) {
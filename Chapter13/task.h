@@ -3,13 +3,17 @@
 #include "chapter_13.h"
 #ifdef SUPPORTS_COROUTINES
 
+// Shared with Chapter 12, where the frame pool is introduced
+#include "../Chapter12/frame_pool.h"
+
 #include <exception>
+#include <utility>
 #include <variant>
 
 template <typename T>
 class [[nodiscard]] Task {
 
-  struct Promise {
+  struct Promise : PooledFrame {
     std::variant<std::monostate, T, std::exception_ptr> result_;
     std::coroutine_handle<> continuation_; // Awaiting coroutine
     auto get_return_object() noexcept { return Task{*this}; }
@@ -64,7 +68,7 @@ public:
 template <>
 class [[nodiscard]] Task<void> {
 
-  struct Promise {
+  struct Promise : PooledFrame {
     std::exception_ptr e_;
     std::coroutine_handle<> continuation_; // Awaiting coroutine
     auto get_return_object() noexcept { return Task{*this}; }
@@ -0,0 +1,171 @@
+#pragma once
+
+#include "work_stealing_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <source_location>
+#include <tuple>
+
+//
+// adaptive_for()
+// A parallel loop that picks its chunk size at runtime instead of taking
+// a chunk_sz argument. The first time a call site runs, the loop body is
+// timed on a prefix of the range that doubles in size until it is long
+// enough to measure. The cost per element is cached for the call site,
+// unless the range ran out before the measurement was long enough, and the
+// chunk size (grain) is chosen so that a chunk takes about
+// target_chunk_time, which is long enough to hide the cost of a fork.
+//
+// The rest of the range is split lazily, as described by Tzannes et al. in
+// "Lazy Binary Splitting": a worker only splits its range in two while its
+// own deque is empty, which means that the idle workers have stolen
+// everything it had forked. Otherwise it processes one grain itself and
+// checks again, so the range is only split as deep as the load requires.
+//
+
+namespace adaptive_detail {
+
+inline constexpr auto target_chunk_time = std::chrono::microseconds{20};
+inline constexpr auto min_probe_time = std::chrono::microseconds{5};
+
+// Nanoseconds per element of every call site that has been measured. Each
+// thread keeps a copy of the costs it has looked up, so the shared map and
+// its mutex are only used the first time a thread runs a call site.
+class CostCache {
+public:
+  static auto get(const std::source_location& site) -> std::optional<double> {
+    auto& local = local_costs();
+    const auto generation = generation_.load(std::memory_order_acquire);
+    if (local.generation_ != generation) {
+      local.costs_.clear(); // clear() was called
+      local.generation_ = generation;
+    }
+    const auto k = key(site);
+    if (const auto it = local.costs_.find(k); it != local.costs_.end()) {
+      return it->second;
+    }
+    auto lock = std::scoped_lock{mutex()};
+    const auto it = costs().find(k);
+    if (it == costs().end()) {
+      return std::nullopt;
+    }
+    local.costs_.emplace(k, it->second);
+    return it->second;
+  }
+  static void put(const std::source_location& site, double ns_per_element) {
+    auto lock = std::scoped_lock{mutex()};
+    costs()[key(site)] = ns_per_element;
+  }
+  static void clear() {
+    auto lock = std::scoped_lock{mutex()};
+    costs().clear();
+    generation_.fetch_add(1, std::memory_order_release);
+  }
+
+private:
+  // The file name is not copied, a call site is identified by the address
+  // of its file name. The address may differ between translation units,
+  // which only means that the call site is measured once per unit.
+  using Key = std::tuple<std::uintptr_t, std::uint_least32_t,
+                         std::uint_least32_t>;
+  struct LocalCosts {
+    std::size_t generation_{0};
+    std::map<Key, double> costs_{};
+  };
+  static auto key(const std::source_location& site) noexcept -> Key {
+    return {reinterpret_cast<std::uintptr_t>(site.file_name()), site.line(),
+            site.column()};
+  }
+  static auto mutex() -> std::mutex& {
+    static auto m = std::mutex{};
+    return m;
+  }
+  static auto costs() -> std::map<Key, double>& {
+    static auto c = std::map<Key, double>{};
+    return c;
+  }
+  static auto local_costs() -> LocalCosts& {
+    static thread_local auto c = LocalCosts{};
+    return c;
+  }
+  static inline std::atomic<std::size_t> generation_{0};
+};
+
+template <typename Body>
+void lazy_split(WorkStealingPool& pool, size_t first, size_t last,
+                size_t grain, Body& body) {
+  while (last - first > grain) {
+    if (!pool.has_local_work()) {
+      const auto middle = first + (last - first) / 2;
+      pool.fork_join([&] { lazy_split(pool, first, middle, grain, body); },
+                     [&] { lazy_split(pool, middle, last, grain, body); });
+      return;
+    }
+    body(first, first + grain);
+    first += grain;
+  }
+  body(first, last);
+}
+
+} // namespace adaptive_detail
+
+// The grain for n elements of the given cost, at least a few chunks per
+// worker are kept for load balancing
+inline auto adaptive_grain_size(double ns_per_element, size_t n,
+                                size_t n_workers) -> size_t {
+  const auto max_grain = std::max(size_t{1}, n / (4 * n_workers));
+  const auto target_ns = std::chrono::duration<double, std::nano>{
+      adaptive_detail::target_chunk_time}.count();
+  if (ns_per_element * static_cast<double>(max_grain) <= target_ns) {
+    return max_grain;
+  }
+  return std::max(size_t{1}, static_cast<size_t>(target_ns / ns_per_element));
+}
+
+// The cost per element measured for a call site of adaptive_for()
+inline auto adaptive_cost(const std::source_location& site)
+    -> std::optional<double> {
+  return adaptive_detail::CostCache::get(site);
+}
+
+// Forgets all measurements, for example after the input has changed a lot
+inline void clear_adaptive_costs() { adaptive_detail::CostCache::clear(); }
+
+// Calls body(first, last) for consecutive ranges covering [0, n)
+template <typename Body>
+void adaptive_for(WorkStealingPool& pool, size_t n, Body body,
+                  std::source_location site = std::source_location::current()) {
+  using namespace adaptive_detail;
+  auto first = size_t{0};
+  auto cost = CostCache::get(site);
+  if (!cost) {
+    using clock = std::chrono::steady_clock;
+    auto elapsed = clock::duration{0};
+    for (auto probe = size_t{1}; first < n && elapsed < min_probe_time;
+         probe *= 2) {
+      const auto last = std::min(n, first + probe);
+      const auto start = clock::now();
+      body(first, last);
+      elapsed += clock::now() - start;
+      first = last;
+    }
+    if (elapsed < min_probe_time) {
+      return; // The whole range was too short to measure
+    }
+    cost = std::chrono::duration<double, std::nano>{elapsed}.count() /
+           static_cast<double>(first);
+    CostCache::put(site, *cost);
+  }
+  if (first == n) {
+    return;
+  }
+  const auto grain = adaptive_grain_size(*cost, n - first, pool.size());
+  pool.run([&] { lazy_split(pool, first, n, grain, body); });
+}
@@ -0,0 +1,70 @@
+#include "adaptive_partitioner.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cmath>
+#include <source_location>
+#include <vector>
+
+TEST(AdaptivePartitioner, VisitsEveryIndexOnce) {
+  auto pool = WorkStealingPool{4};
+  for (auto n : {0ul, 1ul, 3ul, 100'000ul}) {
+    auto visits = std::vector<std::atomic<int>>(n);
+    adaptive_for(pool, n, [&](size_t first, size_t last) {
+      ASSERT_LT(first, last);
+      for (auto i = first; i < last; ++i) {
+        visits[i].fetch_add(1);
+      }
+    });
+    for (const auto& v : visits) {
+      ASSERT_EQ(v.load(), 1);
+    }
+  }
+}
+
+TEST(AdaptivePartitioner, CostIsCachedPerCallSite) {
+  auto pool = WorkStealingPool{2};
+  auto cheap_site = std::source_location::current();
+  auto expensive_site = std::source_location::current();
+  auto sink = std::atomic<double>{0};
+  auto sqrt_sum = [&](size_t first, size_t last, int n_terms) {
+    auto sum = 0.0;
+    for (auto i = first; i < last; ++i) {
+      for (auto j = 0; j < n_terms; ++j) {
+        sum += std::sqrt(static_cast<double>(i + j));
+      }
+    }
+    sink.store(sum);
+  };
+  auto cheap = [&](size_t first, size_t last) { sqrt_sum(first, last, 10); };
+  auto expensive = [&](size_t first, size_t last) {
+    sqrt_sum(first, last, 1000);
+  };
+  cheap(0, 1000); // The very first call is slow enough to skew the probe
+  ASSERT_FALSE(adaptive_cost(cheap_site));
+  adaptive_for(pool, 100'000, cheap, cheap_site);
+  adaptive_for(pool, 10'000, expensive, expensive_site);
+  ASSERT_TRUE(adaptive_cost(cheap_site));
+  ASSERT_TRUE(adaptive_cost(expensive_site));
+  ASSERT_LT(*adaptive_cost(cheap_site), *adaptive_cost(expensive_site));
+
+  clear_adaptive_costs();
+  ASSERT_FALSE(adaptive_cost(cheap_site));
+}
+
+TEST(AdaptivePartitioner, ShortRangeIsNotCached) {
+  auto pool = WorkStealingPool{2};
+  const auto site = std::source_location::current();
+  adaptive_for(pool, 3, [](size_t, size_t) {}, site);
+  ASSERT_FALSE(adaptive_cost(site)); // Too short to be measured
+}
+
+TEST(AdaptivePartitioner, GrainSize) {
+  // Cheap elements are limited by the number of chunks per worker
+  ASSERT_EQ(adaptive_grain_size(0.1, 1'000'000, 4), 62'500);
+  // 20 us per chunk
+  ASSERT_EQ(adaptive_grain_size(100.0, 1'000'000, 4), 200);
+  ASSERT_EQ(adaptive_grain_size(1e9, 1'000'000, 4), 1);
+  ASSERT_EQ(adaptive_grain_size(1.0, 2, 4), 1);
+}
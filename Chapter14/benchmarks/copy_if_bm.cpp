@@ -72,6 +72,17 @@ void bm_par_copy_if_split(benchmark::State& state) {
   }
 }
 
+template <class Pred>
+void bm_par_copy_if_stable(benchmark::State& state) {
+  auto [src, dst] = setup_fixture(100'000'000);
+  auto pred = Pred{};
+  for (auto _ : state) {
+    auto new_end =
+        par_copy_if_stable(src.begin(), src.end(), dst.begin(), pred, 100'000);
+    benchmark::DoNotOptimize(new_end);
+  }
+}
+
 void CustomArguments(benchmark::internal::Benchmark* b) {
   b->MeasureProcessCPUTime()->UseRealTime()->Unit(benchmark::kMillisecond);
 }
@@ -81,9 +92,11 @@ void CustomArguments(benchmark::internal::Benchmark* b) {
 BENCHMARK_TEMPLATE(bm_std_copy_if, decltype(is_odd))->Apply(CustomArguments);
 BENCHMARK_TEMPLATE(bm_par_copy_if_split, decltype(is_odd))->Apply(CustomArguments);
 BENCHMARK_TEMPLATE(bm_par_copy_if_sync, decltype(is_odd))->Apply(CustomArguments);
+BENCHMARK_TEMPLATE(bm_par_copy_if_stable, decltype(is_odd))->Apply(CustomArguments);
 
 BENCHMARK_TEMPLATE(bm_std_copy_if, decltype(is_prime))->Apply(CustomArguments);
 BENCHMARK_TEMPLATE(bm_par_copy_if_split, decltype(is_prime))->Apply(CustomArguments);
 BENCHMARK_TEMPLATE(bm_par_copy_if_sync, decltype(is_prime))->Apply(CustomArguments);
+BENCHMARK_TEMPLATE(bm_par_copy_if_stable, decltype(is_prime))->Apply(CustomArguments);
 
 BENCHMARK_MAIN();
\ No newline at end of file
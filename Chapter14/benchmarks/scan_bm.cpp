@@ -0,0 +1,110 @@
+#include "../scan.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <vector>
+#include <version>
+
+#if defined(__cpp_lib_execution) && defined(__cpp_lib_parallel_algorithm)
+#include <execution>
+#endif
+
+namespace {
+
+// Prefix sums of 10 million ints or floats, where the sequential
+// std::inclusive_scan() is the baseline. The chunk size is the argument
+// of par_inclusive_scan().
+
+constexpr auto n = 10'000'000;
+
+// Small values, so that the sum of all ints fits in 32 bits
+template <typename T>
+auto setup_fixture() {
+  auto src = std::vector<T>(n);
+  for (auto i = 0; i < n; ++i) {
+    src[i] = static_cast<T>(i % 100);
+  }
+  return src;
+}
+
+template <typename T>
+void bm_std_inclusive_scan(benchmark::State& state) {
+  auto src = setup_fixture<T>();
+  auto dst = std::vector<T>(src.size());
+  for (auto _ : state) {
+    std::inclusive_scan(src.begin(), src.end(), dst.begin());
+    benchmark::DoNotOptimize(dst.data());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+#if defined(__cpp_lib_execution) && defined(__cpp_lib_parallel_algorithm)
+template <typename T>
+void bm_std_inclusive_scan_par(benchmark::State& state) {
+  auto src = setup_fixture<T>();
+  auto dst = std::vector<T>(src.size());
+  for (auto _ : state) {
+    std::inclusive_scan(std::execution::par, src.begin(), src.end(),
+                        dst.begin());
+    benchmark::DoNotOptimize(dst.data());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+#endif
+
+template <typename T>
+void bm_par_inclusive_scan(benchmark::State& state) {
+  auto src = setup_fixture<T>();
+  auto dst = std::vector<T>(src.size());
+  const auto chunk_sz = static_cast<size_t>(state.range(0));
+  for (auto _ : state) {
+    par_inclusive_scan(src.begin(), src.end(), dst.begin(), std::plus<>{},
+                       chunk_sz);
+    benchmark::DoNotOptimize(dst.data());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+// Same as above but with an operation that is not vectorized
+template <typename T>
+void bm_par_inclusive_scan_scalar(benchmark::State& state) {
+  auto src = setup_fixture<T>();
+  auto dst = std::vector<T>(src.size());
+  const auto chunk_sz = static_cast<size_t>(state.range(0));
+  auto add = [](T a, T b) { return a + b; };
+  for (auto _ : state) {
+    par_inclusive_scan(src.begin(), src.end(), dst.begin(), add, chunk_sz);
+    benchmark::DoNotOptimize(dst.data());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+void CustomArguments(benchmark::internal::Benchmark* b) {
+  b->UseRealTime()->Unit(benchmark::kMillisecond);
+}
+
+void ChunkArguments(benchmark::internal::Benchmark* b) {
+  b->ArgName("chunk")->Arg(100'000)->Arg(1'000'000);
+  CustomArguments(b);
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(bm_std_inclusive_scan, std::int32_t)->Apply(CustomArguments);
+#if defined(__cpp_lib_execution) && defined(__cpp_lib_parallel_algorithm)
+BENCHMARK_TEMPLATE(bm_std_inclusive_scan_par, std::int32_t)->Apply(CustomArguments);
+#endif
+BENCHMARK_TEMPLATE(bm_par_inclusive_scan, std::int32_t)->Apply(ChunkArguments);
+BENCHMARK_TEMPLATE(bm_par_inclusive_scan_scalar, std::int32_t)->Apply(ChunkArguments);
+
+BENCHMARK_TEMPLATE(bm_std_inclusive_scan, float)->Apply(CustomArguments);
+#if defined(__cpp_lib_execution) && defined(__cpp_lib_parallel_algorithm)
+BENCHMARK_TEMPLATE(bm_std_inclusive_scan_par, float)->Apply(CustomArguments);
+#endif
+BENCHMARK_TEMPLATE(bm_par_inclusive_scan, float)->Apply(ChunkArguments);
+BENCHMARK_TEMPLATE(bm_par_inclusive_scan_scalar, float)->Apply(ChunkArguments);
+
+BENCHMARK_MAIN();
@@ -6,6 +6,7 @@
 #include <tuple>
 #include <vector>
 #include <numeric>
+#include <source_location>
 
 namespace {
 
@@ -43,6 +44,38 @@ void bm_parallel_naive(benchmark::State& state) {
   }
 }
 
+// The same on the shared work-stealing pool instead of std::async()
+void bm_parallel_pool(benchmark::State& state) {
+  auto [src, dst, f] = setup_fixture(10'000'000);
+  auto chunk_sz = state.range(0);
+  auto& pool = WorkStealingPool::global();
+  for (auto _ : state) {
+    par_transform(pool, src.begin(), src.end(), dst.begin(), f, chunk_sz);
+  }
+}
+
+// The chunk size is chosen by measuring f, instead of the sweep above
+void bm_parallel_pool_adaptive(benchmark::State& state) {
+  auto [src, dst, f] = setup_fixture(10'000'000);
+  auto& pool = WorkStealingPool::global();
+  const auto site = std::source_location::current();
+  for (auto _ : state) {
+    par_transform(pool, src.begin(), src.end(), dst.begin(), f, site);
+  }
+  const auto ns_per_element = adaptive_cost(site).value_or(0.0);
+  state.counters["ns_per_element"] = ns_per_element;
+  state.counters["grain"] = static_cast<double>(
+      adaptive_grain_size(ns_per_element, src.size(), pool.size()));
+}
+
+void bm_parallel_naive_pool(benchmark::State& state) {
+  auto [src, dst, f] = setup_fixture(10'000'000);
+  auto& pool = WorkStealingPool::global();
+  for (auto _ : state) {
+    par_transform_naive(pool, src.begin(), src.end(), dst.begin(), f);
+  }
+}
+
 void CustomArguments(benchmark::internal::Benchmark* b) {
   b->MeasureProcessCPUTime()->UseRealTime()->Unit(benchmark::kMillisecond);
 }
@@ -53,5 +86,10 @@ BENCHMARK(bm_parallel)->Apply(CustomArguments)
      ->RangeMultiplier(10)
      ->Range(10000, 10'000'000);
 BENCHMARK(bm_parallel_naive)->Apply(CustomArguments);
+BENCHMARK(bm_parallel_pool)->Apply(CustomArguments)
+     ->RangeMultiplier(10)
+     ->Range(10000, 10'000'000);
+BENCHMARK(bm_parallel_naive_pool)->Apply(CustomArguments);
+BENCHMARK(bm_parallel_pool_adaptive)->Apply(CustomArguments);
 
 BENCHMARK_MAIN();
@@ -1,8 +1,14 @@
 #pragma once
 
+#include "work_stealing_pool.h"
+
+#include <algorithm>
 #include <atomic>
 #include <cassert>
 #include <future>
+#include <iterator>
+#include <numeric>
+#include <utility>
 #include <vector>
 
 //
@@ -84,4 +90,216 @@ auto par_copy_if_split(SrcIt first, SrcIt last, DstIt dst, Pred pred,
     new_end = std::move(chunk_range.first, chunk_range.second, new_end);
   }
   return new_end;
-}
\ No newline at end of file
+}
+
+//
+// par_copy_if_sync() and par_copy_if_split() running on a WorkStealingPool
+//
+
+template <typename SrcIt, typename DstIt, typename Pred>
+auto inner_par_copy_if_sync(WorkStealingPool& pool, SrcIt first, SrcIt last,
+                            DstIt dst, std::atomic_size_t& dst_idx,
+                            Pred pred, size_t chunk_sz) -> void {
+  auto n = static_cast<size_t>(std::distance(first, last));
+  if (n <= chunk_sz) {
+    inner_par_copy_if_sync(first, last, dst, dst_idx, pred, chunk_sz);
+    return;
+  }
+  auto middle = std::next(first, n / 2);
+  pool.fork_join(
+      [&] {
+        inner_par_copy_if_sync(pool, first, middle, dst, dst_idx, pred,
+                               chunk_sz);
+      },
+      [&] {
+        inner_par_copy_if_sync(pool, middle, last, dst, dst_idx, pred,
+                               chunk_sz);
+      });
+}
+
+template <typename SrcIt, typename DstIt, typename Pred>
+auto par_copy_if_sync(WorkStealingPool& pool, SrcIt first, SrcIt last,
+                      DstIt dst, Pred pred, size_t chunk_sz) {
+  auto&& dst_write_idx = std::atomic_size_t{0};
+  inner_par_copy_if_sync(pool, first, last, dst, dst_write_idx, pred,
+                         chunk_sz);
+  return std::next(dst, dst_write_idx);
+}
+
+template <typename SrcIt, typename DstIt, typename Pred>
+auto par_copy_if_split(WorkStealingPool& pool, SrcIt first, SrcIt last,
+                       DstIt dst, Pred pred, size_t chunk_sz) -> DstIt {
+  auto n = static_cast<size_t>(std::distance(first, last));
+  auto n_chunks = (n + chunk_sz - 1) / chunk_sz;
+  auto chunk_ranges = std::vector<std::pair<DstIt, DstIt>>(n_chunks);
+
+  pool.parallel_for(n_chunks, [&](size_t chunk) {
+    const auto i = chunk * chunk_sz;
+    const auto stop_idx = std::min(i + chunk_sz, n);
+    auto dst_first = dst + i;
+    auto dst_last = std::copy_if(first + i, first + stop_idx, dst_first, pred);
+    chunk_ranges[chunk] = std::make_pair(dst_first, dst_last);
+  });
+
+  if (chunk_ranges.empty()) {
+    return dst;
+  }
+  auto new_end = chunk_ranges.front().second;
+  for (auto it = std::next(chunk_ranges.begin()); it != chunk_ranges.end();
+       ++it) {
+    new_end = std::move(it->first, it->second, new_end);
+  }
+  return new_end;
+}
+
+//
+// par_copy_if_stable()
+// Order preserving parallel copy_if() in two passes. The first pass
+// evaluates the predicate and counts the matches of each chunk, an
+// exclusive scan of the counts gives the position of each chunk in the
+// output and the second pass copies all chunks in parallel directly to
+// their final position. The results of the predicate are kept between the
+// passes, so an expensive predicate is only evaluated once.
+//
+
+namespace stable_detail {
+
+// Returns the output offset of every chunk, followed by the total count
+template <typename SrcIt, typename Pred>
+auto count_chunks(WorkStealingPool& pool, SrcIt first, size_t n, Pred& pred,
+                  size_t chunk_sz, std::vector<unsigned char>& flags) {
+  const auto n_chunks = (n + chunk_sz - 1) / chunk_sz;
+  auto offsets = std::vector<size_t>(n_chunks + 1, 0);
+  pool.parallel_for(n_chunks, [&](size_t chunk) {
+    const auto stop_idx = std::min((chunk + 1) * chunk_sz, n);
+    auto count = size_t{0};
+    for (auto i = chunk * chunk_sz; i < stop_idx; ++i) {
+      flags[i] = pred(*std::next(first, i)) ? 1 : 0;
+      count += flags[i];
+    }
+    offsets[chunk] = count;
+  });
+  std::exclusive_scan(offsets.begin(), offsets.end(), offsets.begin(),
+                      size_t{0});
+  return offsets;
+}
+
+// Writes the flagged elements of each chunk to dst_true and, if
+// WithFalse, the others to dst_false
+template <bool WithFalse, typename SrcIt, typename DstTrue, typename DstFalse>
+void scatter_chunks(WorkStealingPool& pool, SrcIt first, size_t n,
+                    size_t chunk_sz, const std::vector<unsigned char>& flags,
+                    const std::vector<size_t>& offsets, DstTrue dst_true,
+                    DstFalse dst_false) {
+  pool.parallel_for(offsets.size() - 1, [&](size_t chunk) {
+    const auto start_idx = chunk * chunk_sz;
+    const auto stop_idx = std::min(start_idx + chunk_sz, n);
+    auto out_true = std::next(dst_true, offsets[chunk]);
+    if constexpr (WithFalse) {
+      auto out_false = std::next(dst_false, start_idx - offsets[chunk]);
+      for (auto i = start_idx; i < stop_idx; ++i) {
+        if (flags[i]) {
+          *out_true = *std::next(first, i);
+          ++out_true;
+        } else {
+          *out_false = *std::next(first, i);
+          ++out_false;
+        }
+      }
+    } else {
+      // dst_false is unused and may not have room for the others
+      for (auto i = start_idx; i < stop_idx; ++i) {
+        if (flags[i]) {
+          *out_true = *std::next(first, i);
+          ++out_true;
+        }
+      }
+    }
+  });
+}
+
+} // namespace stable_detail
+
+template <typename SrcIt, typename DstIt, typename Pred>
+auto par_copy_if_stable(WorkStealingPool& pool, SrcIt first, SrcIt last,
+                        DstIt dst, Pred pred, size_t chunk_sz) -> DstIt {
+  const auto n = static_cast<size_t>(std::distance(first, last));
+  auto flags = std::vector<unsigned char>(n);
+  const auto offsets =
+      stable_detail::count_chunks(pool, first, n, pred, chunk_sz, flags);
+  stable_detail::scatter_chunks<false>(pool, first, n, chunk_sz, flags,
+                                       offsets, dst, dst);
+  return std::next(dst, offsets.back());
+}
+
+template <typename SrcIt, typename DstIt, typename Pred>
+auto par_copy_if_stable(SrcIt first, SrcIt last, DstIt dst, Pred pred,
+                        size_t chunk_sz) -> DstIt {
+  return par_copy_if_stable(WorkStealingPool::global(), first, last, dst,
+                            pred, chunk_sz);
+}
+
+// Like std::partition_copy() but in parallel, both outputs keep the
+// original order
+template <typename SrcIt, typename DstTrue, typename DstFalse, typename Pred>
+auto par_partition_copy_stable(WorkStealingPool& pool, SrcIt first,
+                               SrcIt last, DstTrue dst_true,
+                               DstFalse dst_false, Pred pred, size_t chunk_sz)
+    -> std::pair<DstTrue, DstFalse> {
+  const auto n = static_cast<size_t>(std::distance(first, last));
+  auto flags = std::vector<unsigned char>(n);
+  const auto offsets =
+      stable_detail::count_chunks(pool, first, n, pred, chunk_sz, flags);
+  stable_detail::scatter_chunks<true>(pool, first, n, chunk_sz, flags,
+                                      offsets, dst_true, dst_false);
+  return {std::next(dst_true, offsets.back()),
+          std::next(dst_false, n - offsets.back())};
+}
+
+// In-place versions of std::stable_partition() and std::remove_if(). The
+// elements are scattered to a buffer, since a chunk could otherwise
+// overwrite elements that another chunk has not read yet, and then moved
+// back in parallel.
+template <typename It, typename Pred>
+auto par_stable_partition(WorkStealingPool& pool, It first, It last, Pred pred,
+                          size_t chunk_sz) -> It {
+  const auto n = static_cast<size_t>(std::distance(first, last));
+  auto flags = std::vector<unsigned char>(n);
+  const auto offsets =
+      stable_detail::count_chunks(pool, first, n, pred, chunk_sz, flags);
+  auto buffer = std::vector<typename std::iterator_traits<It>::value_type>(n);
+  const auto n_true = offsets.back();
+  stable_detail::scatter_chunks<true>(
+      pool, std::make_move_iterator(first), n, chunk_sz, flags, offsets,
+      buffer.begin(), std::next(buffer.begin(), n_true));
+  pool.parallel_for((n + chunk_sz - 1) / chunk_sz, [&](size_t chunk) {
+    const auto start_idx = chunk * chunk_sz;
+    const auto stop_idx = std::min(start_idx + chunk_sz, n);
+    std::move(buffer.begin() + start_idx, buffer.begin() + stop_idx,
+              std::next(first, start_idx));
+  });
+  return std::next(first, n_true);
+}
+
+template <typename It, typename Pred>
+auto par_remove_if_stable(WorkStealingPool& pool, It first, It last, Pred pred,
+                          size_t chunk_sz) -> It {
+  auto keep = [&pred](const auto& v) -> bool { return !pred(v); };
+  const auto n = static_cast<size_t>(std::distance(first, last));
+  auto flags = std::vector<unsigned char>(n);
+  const auto offsets =
+      stable_detail::count_chunks(pool, first, n, keep, chunk_sz, flags);
+  const auto n_kept = offsets.back();
+  auto buffer =
+      std::vector<typename std::iterator_traits<It>::value_type>(n_kept);
+  stable_detail::scatter_chunks<false>(pool, std::make_move_iterator(first),
+                                       n, chunk_sz, flags, offsets,
+                                       buffer.begin(), buffer.begin());
+  pool.parallel_for((n_kept + chunk_sz - 1) / chunk_sz, [&](size_t chunk) {
+    const auto start_idx = chunk * chunk_sz;
+    const auto stop_idx = std::min(start_idx + chunk_sz, n_kept);
+    std::move(buffer.begin() + start_idx, buffer.begin() + stop_idx,
+              std::next(first, start_idx));
+  });
+  return std::next(first, n_kept);
+}
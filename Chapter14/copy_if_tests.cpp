@@ -5,8 +5,11 @@
 
 #include "copy_if.h"
 
+#include <algorithm>
 #include <cassert>
 #include <execution>
+#include <numeric>
+#include <string>
 #include <vector>
 
 TEST(CopyIf, OddNumbers) {
@@ -46,4 +49,111 @@ TEST(CopyIfSyncronizedWritePosition, OddNumbers) {
   ASSERT_EQ(odd_numbers, (std::vector<int>{1, 3, 5, 7, 9, 11, 13, 15}));
 }
 
+TEST(CopyIfSplitIntoTwoParts, OddNumbersOnPool) {
+  auto numbers = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+  auto odd_numbers = std::vector<int>(numbers.size(), -1);
+  auto is_odd = [](int v) { return (v % 2) == 1; };
+
+  auto pool = WorkStealingPool{4};
+  auto end = par_copy_if_split(pool, numbers.begin(), numbers.end(),
+                               odd_numbers.begin(), is_odd, 3);
+  odd_numbers.erase(end, odd_numbers.end());
+  ASSERT_EQ(odd_numbers, (std::vector<int>{1, 3, 5, 7, 9, 11, 13, 15}));
+}
+
+TEST(CopyIfSyncronizedWritePosition, OddNumbersOnPool) {
+  auto numbers = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+  auto odd_numbers = std::vector<int>(numbers.size(), -1);
+  auto is_odd = [](int v) { return (v % 2) == 1; };
+
+  auto pool = WorkStealingPool{4};
+  auto end = par_copy_if_sync(pool, numbers.begin(), numbers.end(),
+                              odd_numbers.begin(), is_odd, 4);
+  odd_numbers.erase(end, odd_numbers.end());
+  ASSERT_TRUE(std::all_of(odd_numbers.begin(), odd_numbers.end(), is_odd));
+
+  std::sort(odd_numbers.begin(), odd_numbers.end());
+  ASSERT_EQ(odd_numbers, (std::vector<int>{1, 3, 5, 7, 9, 11, 13, 15}));
+}
+
+TEST(CopyIfStable, OddNumbers) {
+  auto numbers = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+  auto odd_numbers = std::vector<int>(numbers.size(), -1);
+  auto is_odd = [](int v) { return (v % 2) == 1; };
+
+  auto end = par_copy_if_stable(numbers.begin(), numbers.end(),
+                                odd_numbers.begin(), is_odd, 3);
+  odd_numbers.erase(end, odd_numbers.end());
+  ASSERT_EQ(odd_numbers, (std::vector<int>{1, 3, 5, 7, 9, 11, 13, 15}));
+}
+
+TEST(CopyIfStable, SameOrderAsStdCopyIf) {
+  auto numbers = std::vector<int>(10'000);
+  std::iota(numbers.begin(), numbers.end(), 0);
+  std::reverse(numbers.begin() + 100, numbers.end());
+  auto pred = [](int v) { return v % 7 == 3 || v % 5 == 0; };
+  auto expected = std::vector<int>{};
+  std::copy_if(numbers.begin(), numbers.end(), std::back_inserter(expected),
+               pred);
+
+  auto pool = WorkStealingPool{4};
+  auto result = std::vector<int>(numbers.size());
+  auto end = par_copy_if_stable(pool, numbers.begin(), numbers.end(),
+                                result.begin(), pred, 97);
+  result.erase(end, result.end());
+  ASSERT_EQ(result, expected);
+}
+
+TEST(CopyIfStable, OutputSizedToResult) {
+  auto numbers = std::vector<int>(100);
+  std::iota(numbers.begin(), numbers.end(), 0);
+  auto pred = [](int v) { return v >= 90; };
+  auto pool = WorkStealingPool{4};
+  auto result = std::vector<int>(10); // No room for the others
+  auto end = par_copy_if_stable(pool, numbers.begin(), numbers.end(),
+                                result.begin(), pred, 10);
+  ASSERT_EQ(end, result.end());
+  ASSERT_EQ(result.front(), 90);
+  ASSERT_EQ(result.back(), 99);
+}
+
+TEST(PartitionStable, PartitionCopyAndInPlace) {
+  auto words = std::vector<std::string>{"ant",  "bee",  "cat",  "dog",
+                                        "eel",  "fox",  "gnu",  "hen",
+                                        "ibis", "jay",  "kiwi", "lynx"};
+  auto is_short = [](const std::string& s) { return s.size() == 3; };
+  auto pool = WorkStealingPool{4};
+
+  auto shorts = std::vector<std::string>(words.size());
+  auto longs = std::vector<std::string>(words.size());
+  auto [short_end, long_end] = par_partition_copy_stable(
+      pool, words.begin(), words.end(), shorts.begin(), longs.begin(),
+      is_short, 5);
+  shorts.erase(short_end, shorts.end());
+  longs.erase(long_end, longs.end());
+  ASSERT_EQ(longs, (std::vector<std::string>{"ibis", "kiwi", "lynx"}));
+  ASSERT_EQ(shorts.size(), 9);
+
+  auto expected = words;
+  std::stable_partition(expected.begin(), expected.end(), is_short);
+  auto middle =
+      par_stable_partition(pool, words.begin(), words.end(), is_short, 5);
+  ASSERT_EQ(middle - words.begin(), 9);
+  ASSERT_EQ(words, expected);
+}
+
+TEST(RemoveIfStable, SameResultAsStdRemoveIf) {
+  auto words = std::vector<std::string>{"ant", "ibis", "bee", "kiwi", "cat",
+                                        "lynx", "dog", "emu", "gnu"};
+  auto is_long = [](const std::string& s) { return s.size() > 3; };
+  auto pool = WorkStealingPool{4};
+
+  auto expected = words;
+  expected.erase(std::remove_if(expected.begin(), expected.end(), is_long),
+                 expected.end());
+  words.erase(par_remove_if_stable(pool, words.begin(), words.end(), is_long, 2),
+              words.end());
+  ASSERT_EQ(words, expected);
+}
+
 #endif // par execution
\ No newline at end of file
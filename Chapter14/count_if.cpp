@@ -2,10 +2,16 @@
 //#include <version>
 //#if defined(__cpp_lib_execution) && defined(__cpp_lib_parallel_algorithm)
 
+#include "adaptive_partitioner.h"
+#include "work_stealing_pool.h"
+
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <atomic>
 #include <future>
+#include <numeric>
+#include <source_location>
 #include <vector>
 
 template <typename It, typename Pred>
@@ -29,9 +35,62 @@ auto par_count_if(It first, It last, Pred pred) {
   return par_count_if(first, last, pred, chunk_sz);
 }
 
+// The same on a WorkStealingPool
+template <typename It, typename Pred>
+auto par_count_if(WorkStealingPool& pool, It first, It last, Pred pred,
+                  size_t chunk_sz) {
+  auto n = static_cast<size_t>(std::distance(first, last));
+  if (n <= chunk_sz)
+    return std::count_if(first, last, pred);
+  auto middle = std::next(first, n / 2);
+  auto num_first = decltype(std::count_if(first, last, pred)){0};
+  auto num_last = num_first;
+  pool.fork_join(
+      [&] { num_first = par_count_if(pool, first, middle, pred, chunk_sz); },
+      [&] { num_last = par_count_if(pool, middle, last, pred, chunk_sz); });
+  return num_first + num_last;
+}
+
+// With a chunk size chosen at runtime, instead of the fixed formula above
+template <typename It, typename Pred>
+auto par_count_if(WorkStealingPool& pool, It first, It last, Pred pred,
+                  std::source_location site = std::source_location::current()) {
+  auto n = static_cast<size_t>(std::distance(first, last));
+  auto num = std::atomic<decltype(std::count_if(first, last, pred))>{0};
+  adaptive_for(
+      pool, n,
+      [&](size_t i, size_t j) {
+        num.fetch_add(std::count_if(std::next(first, i), std::next(first, j),
+                                    pred),
+                      std::memory_order_relaxed);
+      },
+      site);
+  return num.load();
+}
+
 TEST(CountIf, OddNumbers) {
   auto numbers = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
   auto is_odd = [](int v) { return (v % 2) == 1; };
   auto count = par_count_if(numbers.begin(), numbers.end(), is_odd);
   ASSERT_EQ(numbers.size() / 2, count);
 }
+
+TEST(CountIf, OddNumbersOnPool) {
+  auto numbers = std::vector<int>(100'000);
+  std::iota(numbers.begin(), numbers.end(), 0);
+  auto is_odd = [](int v) { return (v % 2) == 1; };
+  auto pool = WorkStealingPool{4};
+  auto count = par_count_if(pool, numbers.begin(), numbers.end(), is_odd, 100);
+  ASSERT_EQ(numbers.size() / 2, count);
+}
+
+TEST(CountIf, OddNumbersAdaptive) {
+  auto numbers = std::vector<int>(100'000);
+  std::iota(numbers.begin(), numbers.end(), 0);
+  auto is_odd = [](int v) { return (v % 2) == 1; };
+  auto pool = WorkStealingPool{4};
+  for (auto i = 0; i < 3; ++i) { // Measured once, then cached
+    auto count = par_count_if(pool, numbers.begin(), numbers.end(), is_odd);
+    ASSERT_EQ(numbers.size() / 2, count);
+  }
+}
@@ -6,6 +6,7 @@
 #include <algorithm>
 #include <numeric>
 #include <execution>
+#include <functional>
 #include <string>
 #include <vector>
 #include <numeric>
@@ -31,11 +32,13 @@ TEST(ParllelPolicy, Reduce) {
   constexpr auto policy = std::execution::par;
 #endif
 
-  auto tot_size = std::reduce(policy, v.begin(), v.end(),
-                              size_t{0},
-                              [](auto i, const auto& s) {
-                                return i + s.size(); // OK! Thread safe
-                              });
+  // std::reduce() may combine the elements in any order, so the sizes are
+  // computed before reducing them
+  auto tot_size = std::transform_reduce(policy, v.begin(), v.end(),
+                                        size_t{0}, std::plus<>{},
+                                        [](const auto& s) {
+                                          return s.size(); // OK! Thread safe
+                                        });
   (void)(tot_size);
 }
 
@@ -0,0 +1,342 @@
+#pragma once
+
+#include "work_stealing_pool.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <climits>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+//
+// Radix sorts for keys that are integers, floating point numbers or tuples
+// of them, such as std::tie(p.level_, p.score_), returned by a projection.
+// Every key is transformed to an unsigned integer which sorts in the same
+// order: the sign bit of signed integers is flipped, negative floats have
+// all bits flipped and positive floats only the sign bit, and the members
+// of a tuple are concatenated, the first one in the most significant bits.
+//
+// The keys are sorted one byte (digit) at a time. Each pass counts the
+// digits of every chunk in parallel, an exclusive scan of the counts gives
+// every chunk its positions within each digit, and all chunks then move
+// their elements in parallel. A first parallel histogram pass finds the
+// digits that are the same for all keys, which are skipped.
+//
+// Small trivially copyable elements are moved in every pass. Other
+// elements are sorted as (key, index) records, and the elements are moved
+// only once, to their final position.
+//
+
+namespace radix_detail {
+
+inline constexpr auto radix = size_t{256};
+using Histogram = std::array<size_t, radix>;
+
+template <size_t Bytes>
+using UnsignedOfSize = std::conditional_t<
+    Bytes <= 1, std::uint8_t,
+    std::conditional_t<
+        Bytes <= 2, std::uint16_t,
+        std::conditional_t<Bytes <= 4, std::uint32_t, std::uint64_t>>>;
+
+template <typename T>
+  requires std::is_arithmetic_v<T>
+auto to_radix_key(T v) {
+  using U = UnsignedOfSize<sizeof(T)>;
+  constexpr auto sign_bit = static_cast<U>(U{1} << (sizeof(T) * CHAR_BIT - 1));
+  if constexpr (std::is_floating_point_v<T>) {
+    const auto u = std::bit_cast<U>(v);
+    return static_cast<U>((u & sign_bit) ? ~u : (u | sign_bit));
+  } else if constexpr (std::is_signed_v<T>) {
+    return static_cast<U>(static_cast<U>(v) ^ sign_bit);
+  } else {
+    return static_cast<U>(v);
+  }
+}
+
+template <typename... Ts>
+auto to_radix_key(const std::tuple<Ts...>& t) {
+  constexpr auto bytes = (sizeof(std::remove_cvref_t<Ts>) + ...);
+  static_assert(bytes <= sizeof(std::uint64_t), "The key is too wide");
+  using U = UnsignedOfSize<bytes>;
+  return std::apply(
+      [](const auto&... members) {
+        auto key = U{0};
+        ((key = static_cast<U>(
+              (bytes > sizeof(members) ? key << (sizeof(members) * CHAR_BIT)
+                                       : U{0}) |
+              to_radix_key(members))),
+         ...);
+        return key;
+      },
+      t);
+}
+
+template <typename T1, typename T2>
+auto to_radix_key(const std::pair<T1, T2>& p) {
+  return to_radix_key(std::tie(p.first, p.second));
+}
+
+template <typename Key>
+auto digit(Key key, size_t d) {
+  return static_cast<size_t>((key >> (d * CHAR_BIT)) & (radix - 1));
+}
+
+// Every chunk needs a histogram of radix counters, so the number of chunks
+// is limited to a few per worker, however small chunk_sz is
+inline auto counting_chunk_size(const WorkStealingPool& pool, size_t n,
+                                size_t chunk_sz) {
+  constexpr auto chunks_per_worker = size_t{4};
+  const auto max_chunks = chunks_per_worker * std::max(size_t{1}, pool.size());
+  return std::max(chunk_sz, (n + max_chunks - 1) / max_chunks);
+}
+
+// One histogram per digit of the keys of [first, first + n)
+template <typename Key, typename It, typename KeyOf>
+auto histograms(WorkStealingPool& pool, It first, size_t n, KeyOf& key_of,
+                size_t chunk_sz) {
+  const auto n_chunks = (n + chunk_sz - 1) / chunk_sz;
+  auto per_chunk = std::vector<std::array<Histogram, sizeof(Key)>>(n_chunks);
+  pool.parallel_for(n_chunks, [&](size_t chunk) {
+    auto local = std::array<Histogram, sizeof(Key)>{};
+    const auto stop_idx = std::min((chunk + 1) * chunk_sz, n);
+    for (auto i = chunk * chunk_sz; i < stop_idx; ++i) {
+      const auto key = key_of(*std::next(first, i));
+      for (size_t d = 0; d < sizeof(Key); ++d) {
+        ++local[d][digit(key, d)];
+      }
+    }
+    per_chunk[chunk] = local;
+  });
+  auto total = std::array<Histogram, sizeof(Key)>{};
+  for (const auto& local : per_chunk) {
+    for (size_t d = 0; d < sizeof(Key); ++d) {
+      for (size_t b = 0; b < radix; ++b) {
+        total[d][b] += local[d][b];
+      }
+    }
+  }
+  return total;
+}
+
+inline auto is_trivial_digit(const Histogram& h, size_t n) {
+  return std::find(h.begin(), h.end(), n) != h.end();
+}
+
+// Moves [src, src + n) to dst ordered by digit d, keeping the order of
+// elements with the same digit
+template <typename SrcIt, typename DstIt, typename KeyOf>
+void scatter_pass(WorkStealingPool& pool, SrcIt src, DstIt dst, size_t n,
+                  size_t d, KeyOf& key_of, size_t chunk_sz) {
+  const auto n_chunks = (n + chunk_sz - 1) / chunk_sz;
+  // counts[digit * n_chunks + chunk]
+  auto counts = std::vector<size_t>(radix * n_chunks + 1, 0);
+  pool.parallel_for(n_chunks, [&](size_t chunk) {
+    auto local = Histogram{};
+    const auto stop_idx = std::min((chunk + 1) * chunk_sz, n);
+    for (auto i = chunk * chunk_sz; i < stop_idx; ++i) {
+      ++local[digit(key_of(*std::next(src, i)), d)];
+    }
+    for (size_t b = 0; b < radix; ++b) {
+      counts[b * n_chunks + chunk] = local[b];
+    }
+  });
+  std::exclusive_scan(counts.begin(), counts.end(), counts.begin(), size_t{0});
+  pool.parallel_for(n_chunks, [&](size_t chunk) {
+    auto offsets = Histogram{};
+    for (size_t b = 0; b < radix; ++b) {
+      offsets[b] = counts[b * n_chunks + chunk];
+    }
+    const auto stop_idx = std::min((chunk + 1) * chunk_sz, n);
+    for (auto i = chunk * chunk_sz; i < stop_idx; ++i) {
+      auto&& value = *std::next(src, i);
+      *std::next(dst, offsets[digit(key_of(value), d)]++) = std::move(value);
+    }
+  });
+}
+
+template <typename SrcIt, typename DstIt>
+void par_move(WorkStealingPool& pool, SrcIt src, DstIt dst, size_t n,
+              size_t chunk_sz) {
+  pool.parallel_for((n + chunk_sz - 1) / chunk_sz, [&](size_t chunk) {
+    const auto start_idx = chunk * chunk_sz;
+    const auto stop_idx = std::min(start_idx + chunk_sz, n);
+    std::move(std::next(src, start_idx), std::next(src, stop_idx),
+              std::next(dst, start_idx));
+  });
+}
+
+// LSD: one stable pass per digit, from the least significant one
+template <typename Key, typename It, typename KeyOf>
+void lsd_sort(WorkStealingPool& pool, It first, size_t n, KeyOf& key_of,
+              size_t chunk_sz) {
+  chunk_sz = counting_chunk_size(pool, n, chunk_sz);
+  const auto hist = histograms<Key>(pool, first, n, key_of, chunk_sz);
+  auto buffer = std::vector<typename std::iterator_traits<It>::value_type>(n);
+  auto in_buffer = false;
+  for (size_t d = 0; d < sizeof(Key); ++d) {
+    if (is_trivial_digit(hist[d], n)) {
+      continue;
+    }
+    if (in_buffer) {
+      scatter_pass(pool, buffer.begin(), first, n, d, key_of, chunk_sz);
+    } else {
+      scatter_pass(pool, first, buffer.begin(), n, d, key_of, chunk_sz);
+    }
+    in_buffer = !in_buffer;
+  }
+  if (in_buffer) {
+    par_move(pool, buffer.begin(), first, n, chunk_sz);
+  }
+}
+
+// Sequential MSD sort of one bucket, starting with digit d
+template <typename Key, typename It, typename BufIt, typename KeyOf>
+void msd_sort_bucket(It first, size_t n, BufIt buf, size_t d, KeyOf& key_of) {
+  constexpr auto small_bucket = size_t{64};
+  if (n <= small_bucket) {
+    std::sort(first, std::next(first, n), [&](const auto& a, const auto& b) {
+      return key_of(a) < key_of(b);
+    });
+    return;
+  }
+  for (;;) {
+    auto hist = Histogram{};
+    for (size_t i = 0; i < n; ++i) {
+      ++hist[digit(key_of(*std::next(first, i)), d)];
+    }
+    if (!is_trivial_digit(hist, n)) {
+      auto offsets = Histogram{};
+      std::exclusive_scan(hist.begin(), hist.end(), offsets.begin(),
+                          size_t{0});
+      for (size_t i = 0; i < n; ++i) {
+        auto&& value = *std::next(first, i);
+        *std::next(buf, offsets[digit(key_of(value), d)]++) = std::move(value);
+      }
+      std::move(buf, std::next(buf, n), first);
+      if (d > 0) {
+        auto start_idx = size_t{0};
+        for (auto count : hist) {
+          msd_sort_bucket<Key>(std::next(first, start_idx), count,
+                               std::next(buf, start_idx), d - 1, key_of);
+          start_idx += count;
+        }
+      }
+      return;
+    }
+    if (d == 0) {
+      return; // All keys are equal
+    }
+    --d;
+  }
+}
+
+// MSD: the most significant digit that differs is scattered in parallel,
+// then the buckets are sorted in parallel with a sequential MSD sort
+template <typename Key, typename It, typename KeyOf>
+void msd_sort(WorkStealingPool& pool, It first, size_t n, KeyOf& key_of,
+              size_t chunk_sz) {
+  chunk_sz = counting_chunk_size(pool, n, chunk_sz);
+  const auto hist = histograms<Key>(pool, first, n, key_of, chunk_sz);
+  auto d = sizeof(Key) - 1;
+  while (d > 0 && is_trivial_digit(hist[d], n)) {
+    --d;
+  }
+  if (is_trivial_digit(hist[d], n)) {
+    return; // All keys are equal
+  }
+  auto buffer = std::vector<typename std::iterator_traits<It>::value_type>(n);
+  scatter_pass(pool, first, buffer.begin(), n, d, key_of, chunk_sz);
+  par_move(pool, buffer.begin(), first, n, chunk_sz);
+  if (d == 0) {
+    return;
+  }
+  auto starts = Histogram{};
+  std::exclusive_scan(hist[d].begin(), hist[d].end(), starts.begin(),
+                      size_t{0});
+  pool.parallel_for(radix, [&](size_t b) {
+    msd_sort_bucket<Key>(std::next(first, starts[b]), hist[d][b],
+                         std::next(buffer.begin(), starts[b]), d - 1, key_of);
+  });
+}
+
+// Sorts the elements directly or as (key, index) records, see above
+template <typename It, typename Proj, typename SortRecords>
+void radix_sort(WorkStealingPool& pool, It first, It last, Proj& proj,
+                size_t chunk_sz, SortRecords sort_records) {
+  using T = typename std::iterator_traits<It>::value_type;
+  using Key = decltype(to_radix_key(std::invoke(proj, *first)));
+  const auto n = static_cast<size_t>(std::distance(first, last));
+  if (n < 2) {
+    return;
+  }
+  pool.run([&] {
+    if constexpr (std::is_trivially_copyable_v<T> &&
+                  sizeof(T) <= 2 * sizeof(Key)) {
+      auto key_of = [&proj](const T& v) {
+        return to_radix_key(std::invoke(proj, v));
+      };
+      sort_records.template operator()<Key>(first, n, key_of);
+    } else {
+      auto records = std::vector<std::pair<Key, size_t>>(n);
+      pool.parallel_for((n + chunk_sz - 1) / chunk_sz, [&](size_t chunk) {
+        const auto stop_idx = std::min((chunk + 1) * chunk_sz, n);
+        for (auto i = chunk * chunk_sz; i < stop_idx; ++i) {
+          records[i] = {to_radix_key(std::invoke(proj, *std::next(first, i))),
+                        i};
+        }
+      });
+      auto key_of = [](const std::pair<Key, size_t>& r) { return r.first; };
+      sort_records.template operator()<Key>(records.begin(), n, key_of);
+      auto buffer = std::vector<T>(n);
+      pool.parallel_for((n + chunk_sz - 1) / chunk_sz, [&](size_t chunk) {
+        const auto stop_idx = std::min((chunk + 1) * chunk_sz, n);
+        for (auto i = chunk * chunk_sz; i < stop_idx; ++i) {
+          buffer[i] = std::move(*std::next(first, records[i].second));
+        }
+      });
+      par_move(pool, buffer.begin(), first, n, chunk_sz);
+    }
+  });
+}
+
+} // namespace radix_detail
+
+// Stable LSD radix sort by proj(element)
+template <typename It, typename Proj>
+void par_radix_sort(WorkStealingPool& pool, It first, It last, Proj proj,
+                    size_t chunk_sz) {
+  radix_detail::radix_sort(
+      pool, first, last, proj, chunk_sz,
+      [&]<typename Key>(auto records, size_t n, auto& key_of) {
+        radix_detail::lsd_sort<Key>(pool, records, n, key_of, chunk_sz);
+      });
+}
+
+// MSD radix sort by proj(element), not stable
+template <typename It, typename Proj>
+void par_radix_sort_msd(WorkStealingPool& pool, It first, It last, Proj proj,
+                        size_t chunk_sz) {
+  radix_detail::radix_sort(
+      pool, first, last, proj, chunk_sz,
+      [&]<typename Key>(auto records, size_t n, auto& key_of) {
+        radix_detail::msd_sort<Key>(pool, records, n, key_of, chunk_sz);
+      });
+}
+
+template <typename It, typename Proj>
+void par_radix_sort(It first, It last, Proj proj, size_t chunk_sz) {
+  par_radix_sort(WorkStealingPool::global(), first, last, proj, chunk_sz);
+}
+
+template <typename It, typename Proj>
+void par_radix_sort_msd(It first, It last, Proj proj, size_t chunk_sz) {
+  par_radix_sort_msd(WorkStealingPool::global(), first, last, proj, chunk_sz);
+}
@@ -0,0 +1,106 @@
+#include "radix_sort.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+// Same as in Chapter09/example_projections.cpp
+struct Player {
+  std::string name_;
+  int level_{};
+  int score_{};
+};
+
+template <typename T>
+auto random_values(size_t n, T min, T max) {
+  auto engine = std::mt19937{42};
+  auto v = std::vector<T>(n);
+  if constexpr (std::is_floating_point_v<T>) {
+    auto dist = std::uniform_real_distribution<T>{min, max};
+    std::generate(v.begin(), v.end(), [&] { return dist(engine); });
+  } else {
+    auto dist = std::uniform_int_distribution<T>{min, max};
+    std::generate(v.begin(), v.end(), [&] { return dist(engine); });
+  }
+  return v;
+}
+
+} // namespace
+
+TEST(RadixSort, KeyTransformsKeepOrder) {
+  using radix_detail::to_radix_key;
+  ASSERT_LT(to_radix_key(-1), to_radix_key(0));
+  ASSERT_LT(to_radix_key(std::numeric_limits<int>::min()), to_radix_key(-1));
+  ASSERT_LT(to_radix_key(-2.5f), to_radix_key(-1.0f));
+  ASSERT_LT(to_radix_key(-0.5), to_radix_key(0.25));
+  ASSERT_LT(to_radix_key(std::make_tuple(1, -5)),
+            to_radix_key(std::make_tuple(1, 3)));
+  ASSERT_LT(to_radix_key(std::make_tuple(-1, 500)),
+            to_radix_key(std::make_tuple(1, -500)));
+}
+
+TEST(RadixSort, IntegersAndFloats) {
+  auto pool = WorkStealingPool{4};
+  for (auto chunk_sz : {1ul, 100ul, 100'000ul}) {
+    auto ints = random_values<int>(10'000, -1'000'000, 1'000'000);
+    auto expected = ints;
+    std::sort(expected.begin(), expected.end());
+    auto msd = ints;
+    par_radix_sort(pool, ints.begin(), ints.end(), std::identity{}, chunk_sz);
+    ASSERT_EQ(ints, expected);
+    par_radix_sort_msd(pool, msd.begin(), msd.end(), std::identity{},
+                       chunk_sz);
+    ASSERT_EQ(msd, expected);
+  }
+
+  auto u64 = random_values<std::uint64_t>(5000, 0, ~std::uint64_t{0});
+  auto expected_u64 = u64;
+  std::sort(expected_u64.begin(), expected_u64.end());
+  par_radix_sort(u64.begin(), u64.end(), std::identity{}, 64);
+  ASSERT_EQ(u64, expected_u64);
+
+  auto doubles = random_values<double>(5000, -1e6, 1e6);
+  auto expected_doubles = doubles;
+  std::sort(expected_doubles.begin(), expected_doubles.end());
+  par_radix_sort_msd(doubles.begin(), doubles.end(), std::identity{}, 64);
+  ASSERT_EQ(doubles, expected_doubles);
+}
+
+TEST(RadixSort, PlayersByLevelThenScore) {
+  auto players = std::vector<Player>{};
+  const auto levels = random_values<int>(3000, 1, 20);
+  const auto scores = random_values<int>(3000, -100, 100);
+  for (size_t i = 0; i < levels.size(); ++i) {
+    players.push_back({std::to_string(i), levels[i], scores[i]});
+  }
+  auto cmp = [](const Player& lhs, const Player& rhs) {
+    return std::tie(lhs.level_, lhs.score_) < std::tie(rhs.level_, rhs.score_);
+  };
+  auto expected = players;
+  std::stable_sort(expected.begin(), expected.end(), cmp);
+  auto msd = players;
+
+  auto proj = [](const Player& p) { return std::tie(p.level_, p.score_); };
+  auto pool = WorkStealingPool{4};
+  par_radix_sort(pool, players.begin(), players.end(), proj, 100);
+  auto names = [](const std::vector<Player>& v) {
+    auto result = std::vector<std::string>{};
+    for (const auto& p : v) {
+      result.push_back(p.name_);
+    }
+    return result;
+  };
+  ASSERT_EQ(names(players), names(expected)); // LSD is stable
+
+  par_radix_sort_msd(pool, msd.begin(), msd.end(), proj, 100);
+  ASSERT_TRUE(std::is_sorted(msd.begin(), msd.end(), cmp));
+}
@@ -0,0 +1,287 @@
+#pragma once
+
+#include "work_stealing_pool.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+//
+// Parallel prefix sums in three steps. The range is split into blocks and
+// every block is reduced in parallel. The block sums are scanned on the
+// calling thread, which gives the value carried into each block, and
+// finally every block is scanned in parallel starting from its carry. The
+// input is read twice but each block only writes its own part of the
+// output, so the scans can also be done in place. The operation must be
+// associative, but need not be commutative.
+//
+// Sums of arithmetic types in contiguous memory are scanned with SSE2 inside
+// a block: a register of lanes is added to itself shifted by one and two
+// lanes, which leaves the prefix sums of the lanes in the register.
+//
+
+namespace scan_detail {
+
+template <typename SrcIt, typename DstIt, typename Op>
+constexpr auto use_simd() {
+  using T = std::iter_value_t<SrcIt>;
+  return std::contiguous_iterator<SrcIt> && std::contiguous_iterator<DstIt> &&
+         std::is_same_v<T, std::iter_value_t<DstIt>> &&
+         std::is_arithmetic_v<T> && (sizeof(T) == 4 || sizeof(T) == 8) &&
+         (std::is_same_v<Op, std::plus<>> || std::is_same_v<Op, std::plus<T>>);
+}
+
+// Inclusive prefix sum of n values starting from carry, returns the last sum
+template <typename T>
+auto simd_sum_scan(const T* src, T* dst, size_t n, T carry) -> T {
+  auto i = size_t{0};
+#if defined(__SSE2__)
+  if constexpr (std::is_same_v<T, float>) {
+    auto c = _mm_set1_ps(carry);
+    for (; i + 4 <= n; i += 4) {
+      auto x = _mm_loadu_ps(src + i);
+      x = _mm_add_ps(x, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 4)));
+      x = _mm_add_ps(x, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 8)));
+      x = _mm_add_ps(x, c);
+      _mm_storeu_ps(dst + i, x);
+      c = _mm_shuffle_ps(x, x, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+  } else if constexpr (std::is_same_v<T, double>) {
+    auto c = _mm_set1_pd(carry);
+    for (; i + 2 <= n; i += 2) {
+      auto x = _mm_loadu_pd(src + i);
+      x = _mm_add_pd(x, _mm_castsi128_pd(_mm_slli_si128(_mm_castpd_si128(x), 8)));
+      x = _mm_add_pd(x, c);
+      _mm_storeu_pd(dst + i, x);
+      c = _mm_unpackhi_pd(x, x);
+    }
+  } else if constexpr (sizeof(T) == 4) {
+    auto c = _mm_set1_epi32(std::bit_cast<std::int32_t>(carry));
+    for (; i + 4 <= n; i += 4) {
+      auto x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+      x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+      x = _mm_add_epi32(x, _mm_slli_si128(x, 8));
+      x = _mm_add_epi32(x, c);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), x);
+      c = _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+  } else {
+    auto c = _mm_set1_epi64x(std::bit_cast<std::int64_t>(carry));
+    for (; i + 2 <= n; i += 2) {
+      auto x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+      x = _mm_add_epi64(x, _mm_slli_si128(x, 8));
+      x = _mm_add_epi64(x, c);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), x);
+      c = _mm_unpackhi_epi64(x, x);
+    }
+  }
+  if (i > 0) {
+    carry = dst[i - 1];
+  }
+#endif
+  for (; i < n; ++i) {
+    carry = static_cast<T>(carry + src[i]);
+    dst[i] = carry;
+  }
+  return carry;
+}
+
+// Inclusive scan of a block starting from carry, returns the last value
+template <typename SrcIt, typename DstIt, typename T, typename Op>
+auto scan_block(SrcIt first, SrcIt last, DstIt dst, T carry, Op& op) -> T {
+  if constexpr (use_simd<SrcIt, DstIt, Op>()) {
+    const auto n = static_cast<size_t>(std::distance(first, last));
+    return simd_sum_scan(std::to_address(first), std::to_address(dst), n,
+                         carry);
+  } else {
+    for (; first != last; ++first, ++dst) {
+      carry = op(std::move(carry), *first);
+      *dst = carry;
+    }
+    return carry;
+  }
+}
+
+} // namespace scan_detail
+
+template <typename SrcIt, typename DstIt, typename Op>
+auto par_inclusive_scan(WorkStealingPool& pool, SrcIt first, SrcIt last,
+                        DstIt dst, Op op, size_t chunk_sz) -> DstIt {
+  using T = std::iter_value_t<SrcIt>;
+  const auto n = static_cast<size_t>(std::distance(first, last));
+  const auto n_chunks = (n + chunk_sz - 1) / chunk_sz;
+  if (n_chunks <= 1) {
+    if (n > 0) {
+      *dst = *first;
+      scan_detail::scan_block(std::next(first), last, std::next(dst),
+                              T{*dst}, op);
+    }
+    return std::next(dst, n);
+  }
+  auto sums = std::vector<std::optional<T>>(n_chunks - 1);
+  pool.parallel_for(n_chunks - 1, [&](size_t chunk) {
+    const auto chunk_first = std::next(first, chunk * chunk_sz);
+    sums[chunk] = std::accumulate(std::next(chunk_first),
+                                  std::next(chunk_first, chunk_sz),
+                                  T{*chunk_first}, op);
+  });
+  // sums[i] becomes the value carried into chunk i + 1
+  for (size_t i = 1; i < sums.size(); ++i) {
+    sums[i] = op(*sums[i - 1], *sums[i]);
+  }
+  pool.parallel_for(n_chunks, [&](size_t chunk) {
+    const auto start_idx = chunk * chunk_sz;
+    const auto stop_idx = std::min(start_idx + chunk_sz, n);
+    auto chunk_first = std::next(first, start_idx);
+    auto chunk_dst = std::next(dst, start_idx);
+    if (chunk == 0) {
+      *chunk_dst = *chunk_first;
+      scan_detail::scan_block(std::next(chunk_first),
+                              std::next(first, stop_idx),
+                              std::next(chunk_dst), T{*chunk_dst}, op);
+    } else {
+      scan_detail::scan_block(chunk_first, std::next(first, stop_idx),
+                              chunk_dst, *sums[chunk - 1], op);
+    }
+  });
+  return std::next(dst, n);
+}
+
+template <typename SrcIt, typename DstIt, typename T, typename Op>
+auto par_exclusive_scan(WorkStealingPool& pool, SrcIt first, SrcIt last,
+                        DstIt dst, T init, Op op, size_t chunk_sz) -> DstIt {
+  const auto n = static_cast<size_t>(std::distance(first, last));
+  if (n == 0) {
+    return dst;
+  }
+  const auto n_chunks = (n + chunk_sz - 1) / chunk_sz;
+  auto carries = std::vector<std::optional<T>>(n_chunks);
+  carries[0] = std::move(init);
+  pool.parallel_for(n_chunks - 1, [&](size_t chunk) {
+    const auto chunk_first = std::next(first, chunk * chunk_sz);
+    carries[chunk + 1] =
+        std::accumulate(std::next(chunk_first),
+                        std::next(chunk_first, chunk_sz),
+                        static_cast<T>(*chunk_first), op);
+  });
+  for (size_t i = 1; i < carries.size(); ++i) {
+    carries[i] = op(*carries[i - 1], *carries[i]);
+  }
+  pool.parallel_for(n_chunks, [&](size_t chunk) {
+    const auto start_idx = chunk * chunk_sz;
+    const auto stop_idx = std::min(start_idx + chunk_sz, n);
+    auto acc = *carries[chunk];
+    auto out = std::next(dst, start_idx);
+    if constexpr (scan_detail::use_simd<SrcIt, DstIt, Op>() &&
+                  std::is_same_v<T, std::iter_value_t<SrcIt>>) {
+      // The shifted output would overwrite unread input when in place
+      if (std::to_address(first) != std::to_address(dst)) {
+        *out = acc;
+        scan_detail::simd_sum_scan(std::to_address(first) + start_idx,
+                                   std::to_address(out) + 1,
+                                   stop_idx - start_idx - 1, acc);
+        return;
+      }
+    }
+    for (auto i = start_idx; i < stop_idx; ++i, ++out) {
+      auto value = static_cast<T>(*std::next(first, i)); // Read before writing
+      *out = acc;
+      acc = op(std::move(acc), value);
+    }
+  });
+  return std::next(dst, n);
+}
+
+//
+// Segmented inclusive scan, where the scan restarts at every element with
+// a true head flag. The blocks are summarized by whether they contain a
+// head and the sum after their last head, which is all that is needed to
+// compute the value carried into the next block.
+//
+
+template <typename SrcIt, typename FlagIt, typename DstIt, typename Op>
+auto par_segmented_inclusive_scan(WorkStealingPool& pool, SrcIt first,
+                                  SrcIt last, FlagIt heads, DstIt dst, Op op,
+                                  size_t chunk_sz) -> DstIt {
+  using T = std::iter_value_t<SrcIt>;
+  struct Summary {
+    bool has_head_{};
+    std::optional<T> tail_{};
+  };
+  const auto n = static_cast<size_t>(std::distance(first, last));
+  if (n == 0) {
+    return dst;
+  }
+  const auto n_chunks = (n + chunk_sz - 1) / chunk_sz;
+  auto scan_chunk = [&](size_t chunk, std::optional<T> acc, auto&& out) {
+    const auto stop_idx = std::min((chunk + 1) * chunk_sz, n);
+    auto has_head = false;
+    for (auto i = chunk * chunk_sz; i < stop_idx; ++i) {
+      auto&& value = *std::next(first, i);
+      if (!acc || *std::next(heads, i)) {
+        has_head = has_head || static_cast<bool>(*std::next(heads, i));
+        acc = value;
+      } else {
+        acc = op(std::move(*acc), value);
+      }
+      out(i, *acc);
+    }
+    return Summary{has_head, std::move(acc)};
+  };
+
+  auto carries = std::vector<Summary>(n_chunks);
+  pool.parallel_for(n_chunks - 1, [&](size_t chunk) {
+    carries[chunk + 1] =
+        scan_chunk(chunk, std::nullopt, [](size_t, const T&) {});
+  });
+  // carries[i] becomes the value carried into chunk i
+  for (size_t i = 2; i < carries.size(); ++i) {
+    auto& c = carries[i];
+    const auto& prev = carries[i - 1];
+    if (!c.has_head_ && prev.tail_) {
+      c.tail_ = op(*prev.tail_, *c.tail_);
+    }
+  }
+  pool.parallel_for(n_chunks, [&](size_t chunk) {
+    scan_chunk(chunk, carries[chunk].tail_, [&](size_t i, const T& v) {
+      *std::next(dst, i) = v;
+    });
+  });
+  return std::next(dst, n);
+}
+
+//
+// Overloads using the global pool
+//
+
+template <typename SrcIt, typename DstIt, typename Op>
+auto par_inclusive_scan(SrcIt first, SrcIt last, DstIt dst, Op op,
+                        size_t chunk_sz) -> DstIt {
+  return par_inclusive_scan(WorkStealingPool::global(), first, last, dst, op,
+                            chunk_sz);
+}
+
+template <typename SrcIt, typename DstIt, typename T, typename Op>
+auto par_exclusive_scan(SrcIt first, SrcIt last, DstIt dst, T init, Op op,
+                        size_t chunk_sz) -> DstIt {
+  return par_exclusive_scan(WorkStealingPool::global(), first, last, dst,
+                            std::move(init), op, chunk_sz);
+}
+
+template <typename SrcIt, typename FlagIt, typename DstIt, typename Op>
+auto par_segmented_inclusive_scan(SrcIt first, SrcIt last, FlagIt heads,
+                                  DstIt dst, Op op, size_t chunk_sz) -> DstIt {
+  return par_segmented_inclusive_scan(WorkStealingPool::global(), first, last,
+                                      heads, dst, op, chunk_sz);
+}
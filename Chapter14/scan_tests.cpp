@@ -0,0 +1,87 @@
+#include "scan.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <string>
+#include <vector>
+
+TEST(Scan, InclusiveScanSameAsStd) {
+  auto pool = WorkStealingPool{4};
+  auto src = std::vector<int>(1003);
+  std::iota(src.begin(), src.end(), -500);
+  auto expected = std::vector<int>(src.size());
+  std::inclusive_scan(src.begin(), src.end(), expected.begin());
+
+  for (auto chunk_sz : {1ul, 7ul, 64ul, 5000ul}) {
+    auto dst = std::vector<int>(src.size());
+    auto end = par_inclusive_scan(pool, src.begin(), src.end(), dst.begin(),
+                                  std::plus<>{}, chunk_sz);
+    ASSERT_EQ(end, dst.end());
+    ASSERT_EQ(dst, expected);
+  }
+}
+
+TEST(Scan, InclusiveScanOtherTypes) {
+  auto pool = WorkStealingPool{4};
+  auto u64 = std::vector<std::uint64_t>(99, 3);
+  par_inclusive_scan(pool, u64.begin(), u64.end(), u64.begin(),
+                     std::plus<std::uint64_t>{}, 10); // In place
+  ASSERT_EQ(u64.front(), 3);
+  ASSERT_EQ(u64.back(), 297);
+
+  auto f = std::vector<float>(37, 0.5f);
+  par_inclusive_scan(pool, f.begin(), f.end(), f.begin(), std::plus<>{}, 8);
+  ASSERT_FLOAT_EQ(f[10], 5.5f);
+  ASSERT_FLOAT_EQ(f.back(), 18.5f);
+
+  // Not commutative
+  auto words = std::vector<std::string>{"a", "b", "c", "d", "e"};
+  par_inclusive_scan(pool, words.begin(), words.end(), words.begin(),
+                     std::plus<>{}, 2);
+  ASSERT_EQ(words,
+            (std::vector<std::string>{"a", "ab", "abc", "abcd", "abcde"}));
+}
+
+TEST(Scan, ExclusiveScanSameAsStd) {
+  auto pool = WorkStealingPool{4};
+  auto src = std::vector<int>(1000);
+  std::iota(src.begin(), src.end(), 1);
+  auto expected = std::vector<long>(src.size());
+  std::exclusive_scan(src.begin(), src.end(), expected.begin(), 10l);
+
+  auto dst = std::vector<long>(src.size());
+  par_exclusive_scan(pool, src.begin(), src.end(), dst.begin(), 10l,
+                     std::plus<>{}, 33);
+  ASSERT_EQ(dst, expected);
+
+  auto same_type = std::vector<long>(src.begin(), src.end());
+  auto copy = std::vector<long>(src.size());
+  par_exclusive_scan(pool, same_type.begin(), same_type.end(), copy.begin(),
+                     10l, std::plus<>{}, 33);
+  ASSERT_EQ(copy, expected);
+  par_exclusive_scan(pool, same_type.begin(), same_type.end(),
+                     same_type.begin(), 10l, std::plus<>{}, 33);
+  ASSERT_EQ(same_type, expected);
+
+  auto empty = std::vector<int>{};
+  ASSERT_EQ(par_exclusive_scan(empty.begin(), empty.end(), dst.begin(), 0,
+                               std::plus<>{}, 4),
+            dst.begin());
+}
+
+TEST(Scan, SegmentedInclusiveScan) {
+  auto pool = WorkStealingPool{4};
+  auto src = std::vector<int>{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+  auto heads = std::vector<bool>{0, 0, 1, 0, 0, 0, 0, 0, 1, 1, 0};
+  auto expected = std::vector<int>{1, 3, 3, 7, 12, 18, 25, 33, 9, 10, 21};
+
+  for (auto chunk_sz : {1ul, 2ul, 3ul, 20ul}) {
+    auto dst = std::vector<int>(src.size());
+    par_segmented_inclusive_scan(pool, src.begin(), src.end(), heads.begin(),
+                                 dst.begin(), std::plus<>{}, chunk_sz);
+    ASSERT_EQ(dst, expected);
+  }
+}
@@ -0,0 +1,202 @@
+#pragma once
+
+#include "work_stealing_pool.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <vector>
+
+//
+// par_sort()
+// Parallel merge sort with the same divide and conquer structure as
+// par_transform(). Ranges of at most chunk_sz elements are sorted with
+// std::sort(), which makes chunk_sz the cutoff to tune. The two sorted
+// halves are merged in parallel as well: the middle element of the larger
+// half is looked up in the other half, which splits the merge into two
+// independent merges. The halves are sorted into a buffer and merged back,
+// or the other way around, so every level of the recursion moves each
+// element only once. Like std::sort(), the sort is not stable.
+//
+
+namespace sort_detail {
+
+template <typename It1, typename It2, typename DstIt, typename Comp>
+void par_merge(WorkStealingPool& pool, It1 a_first, It1 a_last, It2 b_first,
+               It2 b_last, DstIt dst, Comp& comp, size_t chunk_sz) {
+  const auto na = static_cast<size_t>(std::distance(a_first, a_last));
+  const auto nb = static_cast<size_t>(std::distance(b_first, b_last));
+  if (na < nb) {
+    par_merge(pool, b_first, b_last, a_first, a_last, dst, comp, chunk_sz);
+    return;
+  }
+  if (na + nb <= chunk_sz || na == 1) { // A single element can't be split
+    std::merge(std::make_move_iterator(a_first), std::make_move_iterator(a_last),
+               std::make_move_iterator(b_first), std::make_move_iterator(b_last),
+               dst, comp);
+    return;
+  }
+  const auto a_middle = std::next(a_first, na / 2);
+  const auto b_middle = std::lower_bound(b_first, b_last, *a_middle, comp);
+  const auto dst_middle =
+      std::next(dst, na / 2 + std::distance(b_first, b_middle));
+  pool.fork_join(
+      [&] {
+        par_merge(pool, a_first, a_middle, b_first, b_middle, dst, comp,
+                  chunk_sz);
+      },
+      [&] {
+        par_merge(pool, a_middle, a_last, b_middle, b_last, dst_middle, comp,
+                  chunk_sz);
+      });
+}
+
+// Sorts [first, last) into [first, last) or, if to_buffer is true, into
+// the buffer starting at buf
+template <typename It, typename BufIt, typename Comp>
+void merge_sort(WorkStealingPool& pool, It first, It last, BufIt buf,
+                bool to_buffer, Comp& comp, size_t chunk_sz) {
+  const auto n = static_cast<size_t>(std::distance(first, last));
+  if (n <= chunk_sz) {
+    std::sort(first, last, comp);
+    if (to_buffer) {
+      std::move(first, last, buf);
+    }
+    return;
+  }
+  const auto middle = std::next(first, n / 2);
+  const auto buf_middle = std::next(buf, n / 2);
+  const auto buf_last = std::next(buf, n);
+  pool.fork_join(
+      [&] {
+        merge_sort(pool, first, middle, buf, !to_buffer, comp, chunk_sz);
+      },
+      [&] {
+        merge_sort(pool, middle, last, buf_middle, !to_buffer, comp, chunk_sz);
+      });
+  if (to_buffer) {
+    par_merge(pool, first, middle, middle, last, buf, comp, chunk_sz);
+  } else {
+    par_merge(pool, buf, buf_middle, buf_middle, buf_last, first, comp,
+              chunk_sz);
+  }
+}
+
+} // namespace sort_detail
+
+template <typename It, typename Comp>
+void par_sort(WorkStealingPool& pool, It first, It last, Comp comp,
+              size_t chunk_sz) {
+  const auto n = static_cast<size_t>(std::distance(first, last));
+  if (n <= chunk_sz) {
+    std::sort(first, last, comp);
+    return;
+  }
+  auto buffer = std::vector<typename std::iterator_traits<It>::value_type>(n);
+  pool.run([&] {
+    sort_detail::merge_sort(pool, first, last, buffer.begin(), false, comp,
+                            chunk_sz);
+  });
+}
+
+template <typename It>
+void par_sort(It first, It last, size_t chunk_sz) {
+  par_sort(WorkStealingPool::global(), first, last, std::less<>{}, chunk_sz);
+}
+
+//
+// par_sample_sort()
+// Sorts a sample of the elements and uses evenly spaced elements of the
+// sample as splitters between buckets. Each chunk of chunk_sz elements
+// counts how many of its elements belong to each bucket, an exclusive scan
+// of the counts gives the position of every chunk within every bucket and
+// all chunks then move their elements to the buckets in parallel. Finally
+// the buckets are sorted independently. Every element is moved twice,
+// regardless of the size of the input, which is why it pays off for large
+// inputs, as long as the keys are not dominated by a few duplicates.
+//
+
+template <typename It, typename Comp>
+void par_sample_sort(WorkStealingPool& pool, It first, It last, Comp comp,
+                     size_t chunk_sz) {
+  using T = typename std::iterator_traits<It>::value_type;
+  constexpr auto max_buckets = size_t{256};
+  constexpr auto oversampling = size_t{16};
+  const auto n = static_cast<size_t>(std::distance(first, last));
+  const auto n_buckets = std::min(max_buckets, n / chunk_sz);
+  if (n_buckets < 2) {
+    std::sort(first, last, comp);
+    return;
+  }
+
+  // Evenly spaced elements are used as a sample to keep the sort
+  // deterministic, which works poorly for periodic input. With fewer than
+  // oversampling elements per bucket, every element is part of the sample.
+  // The sample refers to the elements instead of copying them, which also
+  // works for move-only types. They stay in place until every element has
+  // been assigned a bucket.
+  auto sample = std::vector<It>{};
+  const auto n_sample = std::min(n, n_buckets * oversampling);
+  sample.reserve(n_sample);
+  for (size_t i = 0; i < n_sample; ++i) {
+    sample.push_back(std::next(first, i * n / n_sample));
+  }
+  std::sort(sample.begin(), sample.end(),
+            [&comp](It a, It b) { return comp(*a, *b); });
+  auto splitters = std::vector<It>{};
+  splitters.reserve(n_buckets - 1);
+  for (size_t i = 1; i < n_buckets; ++i) {
+    splitters.push_back(sample[i * n_sample / n_buckets]);
+  }
+  auto value_less_splitter = [&comp](const T& v, It s) { return comp(v, *s); };
+
+  const auto n_chunks = (n + chunk_sz - 1) / chunk_sz;
+  auto bucket_of = std::vector<std::uint8_t>(n);
+  // counts[bucket * n_chunks + chunk], bucket major for the scan
+  auto counts = std::vector<size_t>(n_buckets * n_chunks + 1, 0);
+  pool.parallel_for(n_chunks, [&](size_t chunk) {
+    // Counted locally, neighbouring chunks share cache lines in counts
+    auto chunk_counts = std::vector<size_t>(n_buckets, 0);
+    const auto stop_idx = std::min((chunk + 1) * chunk_sz, n);
+    for (auto i = chunk * chunk_sz; i < stop_idx; ++i) {
+      const auto bucket = static_cast<size_t>(
+          std::upper_bound(splitters.begin(), splitters.end(),
+                           *std::next(first, i), value_less_splitter) -
+          splitters.begin());
+      bucket_of[i] = static_cast<std::uint8_t>(bucket);
+      ++chunk_counts[bucket];
+    }
+    for (size_t b = 0; b < n_buckets; ++b) {
+      counts[b * n_chunks + chunk] = chunk_counts[b];
+    }
+  });
+  std::exclusive_scan(counts.begin(), counts.end(), counts.begin(), size_t{0});
+
+  auto buffer = std::vector<T>(n);
+  pool.parallel_for(n_chunks, [&](size_t chunk) {
+    auto offsets = std::vector<size_t>(n_buckets);
+    for (size_t b = 0; b < n_buckets; ++b) {
+      offsets[b] = counts[b * n_chunks + chunk];
+    }
+    const auto stop_idx = std::min((chunk + 1) * chunk_sz, n);
+    for (auto i = chunk * chunk_sz; i < stop_idx; ++i) {
+      buffer[offsets[bucket_of[i]]++] = std::move(*std::next(first, i));
+    }
+  });
+
+  pool.parallel_for(n_buckets, [&](size_t bucket) {
+    const auto start_idx = counts[bucket * n_chunks];
+    const auto stop_idx = counts[(bucket + 1) * n_chunks];
+    std::sort(buffer.begin() + start_idx, buffer.begin() + stop_idx, comp);
+    std::move(buffer.begin() + start_idx, buffer.begin() + stop_idx,
+              std::next(first, start_idx));
+  });
+}
+
+template <typename It>
+void par_sample_sort(It first, It last, size_t chunk_sz) {
+  par_sample_sort(WorkStealingPool::global(), first, last, std::less<>{},
+                  chunk_sz);
+}
@@ -0,0 +1,102 @@
+#include "sort.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+auto random_ints(size_t n, int max) {
+  auto engine = std::mt19937{42};
+  auto dist = std::uniform_int_distribution<>{0, max};
+  auto v = std::vector<int>(n);
+  std::generate(v.begin(), v.end(), [&] { return dist(engine); });
+  return v;
+}
+
+} // namespace
+
+TEST(ParSort, MergeSort) {
+  auto pool = WorkStealingPool{4};
+  for (auto chunk_sz : {1ul, 10ul, 1000ul, 20'000ul}) {
+    auto v = random_ints(10'007, 1000);
+    auto expected = v;
+    std::sort(expected.begin(), expected.end());
+    par_sort(pool, v.begin(), v.end(), std::less<>{}, chunk_sz);
+    ASSERT_EQ(v, expected);
+  }
+  auto descending = random_ints(5000, 1'000'000);
+  par_sort(pool, descending.begin(), descending.end(), std::greater<>{}, 64);
+  ASSERT_TRUE(std::is_sorted(descending.begin(), descending.end(),
+                             std::greater<>{}));
+}
+
+TEST(ParSort, SampleSort) {
+  auto pool = WorkStealingPool{4};
+  for (auto chunk_sz : {1ul, 10ul, 1000ul, 20'000ul}) {
+    auto v = random_ints(10'007, 1'000'000);
+    auto expected = v;
+    std::sort(expected.begin(), expected.end());
+    par_sample_sort(pool, v.begin(), v.end(), std::less<>{}, chunk_sz);
+    ASSERT_EQ(v, expected);
+  }
+  // Fewer elements than the full sample, all of them are sampled
+  auto small = random_ints(1000, 1'000'000);
+  auto expected_small = small;
+  std::sort(expected_small.begin(), expected_small.end());
+  par_sample_sort(pool, small.begin(), small.end(), std::less<>{}, 1);
+  ASSERT_EQ(small, expected_small);
+  // Many duplicates end up in a few buckets
+  auto few_keys = random_ints(10'000, 3);
+  auto expected = few_keys;
+  std::sort(expected.begin(), expected.end());
+  par_sample_sort(pool, few_keys.begin(), few_keys.end(), std::less<>{}, 100);
+  ASSERT_EQ(few_keys, expected);
+}
+
+TEST(ParSort, MoveOnly) {
+  auto make_ptrs = [] {
+    auto ptrs = std::vector<std::unique_ptr<int>>{};
+    for (auto i : random_ints(3000, 100'000)) {
+      ptrs.push_back(std::make_unique<int>(i));
+    }
+    return ptrs;
+  };
+  auto values = [](const std::vector<std::unique_ptr<int>>& ptrs) {
+    auto v = std::vector<int>{};
+    for (const auto& p : ptrs) {
+      v.push_back(*p);
+    }
+    return v;
+  };
+  auto by_value = [](const auto& a, const auto& b) { return *a < *b; };
+  auto expected = values(make_ptrs());
+  std::sort(expected.begin(), expected.end());
+
+  auto pool = WorkStealingPool{4};
+  auto ptrs = make_ptrs();
+  par_sort(pool, ptrs.begin(), ptrs.end(), by_value, 100);
+  ASSERT_EQ(values(ptrs), expected);
+  ptrs = make_ptrs();
+  par_sample_sort(pool, ptrs.begin(), ptrs.end(), by_value, 100);
+  ASSERT_EQ(values(ptrs), expected);
+}
+
+TEST(ParSort, StringsOnGlobalPool) {
+  auto words = std::vector<std::string>{};
+  for (auto i : random_ints(3000, 100'000)) {
+    words.push_back(std::to_string(i));
+  }
+  auto expected = words;
+  std::sort(expected.begin(), expected.end());
+  auto copy = words;
+  par_sort(words.begin(), words.end(), 100);
+  ASSERT_EQ(words, expected);
+  par_sample_sort(copy.begin(), copy.end(), 100);
+  ASSERT_EQ(copy, expected);
+}
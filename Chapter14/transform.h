@@ -1,9 +1,13 @@
 #pragma once
 
+#include "adaptive_partitioner.h"
+#include "work_stealing_pool.h"
+
 #include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <future>
+#include <source_location>
 #include <vector>
 
 // See benchmarking directory for testing this code
@@ -63,3 +67,56 @@ auto par_transform(SrcIt first, SrcIt last, DstIt dst, Func func,
   par_transform(src_middle, last, dst_middle, func, chunk_sz);
   future.wait();
 }
+
+//
+// The same algorithms running on a WorkStealingPool instead of starting a
+// new thread for each task
+//
+
+template <typename SrcIt, typename DstIt, typename Func>
+auto par_transform_naive(WorkStealingPool& pool, SrcIt first, SrcIt last,
+                         DstIt dst, Func f) {
+  auto n = static_cast<size_t>(std::distance(first, last));
+  auto n_tasks = pool.size();
+  auto chunk_sz = (n + n_tasks - 1) / n_tasks;
+  pool.parallel_for(n_tasks, [=](size_t i) {
+    auto start = chunk_sz * i;
+    if (start < n) {
+      auto stop = std::min(chunk_sz * (i + 1), n);
+      std::transform(first + start, first + stop, dst + start, f);
+    }
+  });
+}
+
+template <typename SrcIt, typename DstIt, typename Func>
+auto par_transform(WorkStealingPool& pool, SrcIt first, SrcIt last,
+                   DstIt dst, Func func, size_t chunk_sz) {
+  const auto n = static_cast<size_t>(std::distance(first, last));
+  if (n <= chunk_sz) {
+    std::transform(first, last, dst, func);
+    return;
+  }
+  const auto src_middle = std::next(first, n / 2);
+  const auto dst_middle = std::next(dst, n / 2);
+  pool.fork_join(
+      [&] { par_transform(pool, first, src_middle, dst, func, chunk_sz); },
+      [&] {
+        par_transform(pool, src_middle, last, dst_middle, func, chunk_sz);
+      });
+}
+
+// par_transform() with a chunk size chosen at runtime, see
+// adaptive_partitioner.h
+template <typename SrcIt, typename DstIt, typename Func>
+auto par_transform(WorkStealingPool& pool, SrcIt first, SrcIt last,
+                   DstIt dst, Func func,
+                   std::source_location site = std::source_location::current()) {
+  const auto n = static_cast<size_t>(std::distance(first, last));
+  adaptive_for(
+      pool, n,
+      [&](size_t i, size_t j) {
+        std::transform(std::next(first, i), std::next(first, j),
+                       std::next(dst, i), func);
+      },
+      site);
+}
@@ -44,3 +44,49 @@ TEST(Transform, DivideAndConquer) {
     ASSERT_TRUE(dst.at(i) == f(src.at(i)));
   }
 }
+
+TEST(Transform, NaiveParallelOnPool) {
+  const auto n = 1'000'000ul;
+  auto src = std::vector<int>(n);
+  std::iota(src.begin(), src.end(), 0);
+  auto dst = std::vector<int>(src.size());
+  auto f = [](int x) { return x * x; };
+  par_transform_naive(WorkStealingPool::global(), src.begin(), src.end(),
+                      dst.begin(), f);
+
+  for (size_t i = 0; i < dst.size(); ++i) {
+    ASSERT_TRUE(dst.at(i) == f(src.at(i)));
+  }
+}
+
+TEST(Transform, DivideAndConquerOnPool) {
+  const auto n = 1'000'000ul;
+  const auto chunk_sz = 1'000ul;
+
+  auto src = std::vector<int>(n);
+  std::iota(src.begin(), src.end(), 0);
+  auto dst = std::vector<int>(src.size());
+  auto f = [](int x) { return x * x; };
+
+  auto pool = WorkStealingPool{4};
+  par_transform(pool, src.begin(), src.end(), dst.begin(), f, chunk_sz);
+  for (size_t i = 0; i < dst.size(); ++i) {
+    ASSERT_TRUE(dst.at(i) == f(src.at(i)));
+  }
+}
+
+TEST(Transform, AdaptiveOnPool) {
+  auto src = std::vector<int>(1'000'000);
+  std::iota(src.begin(), src.end(), 0);
+  auto dst = std::vector<int>(src.size());
+  auto f = [](int x) { return x * x; };
+
+  auto pool = WorkStealingPool{4};
+  for (auto n : {0ul, 1ul, 1000ul, src.size()}) {
+    std::fill(dst.begin(), dst.end(), -1);
+    par_transform(pool, src.begin(), src.begin() + n, dst.begin(), f);
+    for (size_t i = 0; i < n; ++i) {
+      ASSERT_TRUE(dst.at(i) == f(src.at(i)));
+    }
+  }
+}
@@ -0,0 +1,429 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+//
+// A thread pool with one work-stealing deque per worker, used as an
+// alternative to starting a new thread with std::async() for every chunk.
+//
+// fork_join(a, b) pushes a to the deque of the calling worker, runs b
+// itself and then waits for a. Idle workers steal from the top of the
+// other deques, which is where the oldest and therefore largest pieces of
+// a divide and conquer algorithm are. While waiting, a worker pops and
+// steals jobs itself instead of blocking, so nested fork_join() calls
+// never tie up a thread. The jobs live on the stack of the forking thread
+// and no memory is allocated per fork.
+//
+// Calls from threads outside of the pool are handed over to a worker and
+// the calling thread blocks until the work is done.
+//
+
+inline constexpr auto cache_line_size = std::size_t{64};
+
+// A type erased reference to a callable, run at most once
+class Job {
+public:
+  template <typename F>
+  explicit Job(F& f) noexcept
+      : f_{&f}, invoke_{[](void* f) { (*static_cast<F*>(f))(); }} {}
+
+  void run() noexcept {
+    try {
+      invoke_(f_);
+    } catch (...) {
+      exception_ = std::current_exception();
+    }
+    // The job might be destroyed as soon as this is observed
+    done_.store(true, std::memory_order_release);
+  }
+  auto is_done() const noexcept {
+    return done_.load(std::memory_order_acquire);
+  }
+  void rethrow_if_failed() const {
+    if (exception_) {
+      std::rethrow_exception(exception_);
+    }
+  }
+
+private:
+  void* f_{};
+  void (*invoke_)(void*){};
+  std::exception_ptr exception_{};
+  std::atomic<bool> done_{false};
+};
+
+//
+// Chase-Lev deque, as described by Lê, Pop, Cohen and Zappa Nardelli in
+// "Correct and Efficient Work-Stealing for Weak Memory Models". The owner
+// pushes and pops at the bottom, other threads steal from the top. The
+// array grows when full; old arrays are kept until the deque is destroyed
+// since a thief might still be reading from them. The elements are stored
+// with release and loaded with acquire, which costs nothing extra on x86
+// and lets ThreadSanitizer, which ignores fences, see the synchronization.
+//
+template <typename T>
+class ChaseLevDeque {
+  static_assert(std::is_pointer_v<T>);
+
+  class Array {
+  public:
+    explicit Array(std::int64_t capacity)
+        : mask_{capacity - 1},
+          items_{std::make_unique<std::atomic<T>[]>(capacity)} {}
+    auto capacity() const noexcept { return mask_ + 1; }
+    auto get(std::int64_t i) const noexcept {
+      return items_[i & mask_].load(std::memory_order_acquire);
+    }
+    void put(std::int64_t i, T t) noexcept {
+      items_[i & mask_].store(t, std::memory_order_release);
+    }
+
+  private:
+    std::int64_t mask_{};
+    std::unique_ptr<std::atomic<T>[]> items_{};
+  };
+
+public:
+  // capacity must be a power of two
+  explicit ChaseLevDeque(std::int64_t capacity = 64) {
+    arrays_.push_back(std::make_unique<Array>(capacity));
+    array_.store(arrays_.back().get(), std::memory_order_relaxed);
+  }
+  ChaseLevDeque(const ChaseLevDeque&) = delete;
+  ChaseLevDeque& operator=(const ChaseLevDeque&) = delete;
+
+  // Owner only
+  void push(T t);
+  // Owner only, returns nullptr if the deque is empty
+  auto pop() noexcept -> T;
+  // Any thread, returns nullptr if the deque is empty or if another thread
+  // took the top element first
+  auto steal() noexcept -> T;
+
+  auto empty() const noexcept {
+    return bottom_.load(std::memory_order_seq_cst) <=
+           top_.load(std::memory_order_seq_cst);
+  }
+
+private:
+  alignas(cache_line_size) std::atomic<std::int64_t> top_{0};
+  alignas(cache_line_size) std::atomic<std::int64_t> bottom_{0};
+  std::atomic<Array*> array_{};
+  std::vector<std::unique_ptr<Array>> arrays_{}; // Owner only
+};
+
+template <typename T>
+void ChaseLevDeque<T>::push(T t) {
+  const auto b = bottom_.load(std::memory_order_relaxed);
+  const auto top = top_.load(std::memory_order_acquire);
+  auto* a = array_.load(std::memory_order_relaxed);
+  if (b - top > a->capacity() - 1) {
+    auto bigger = std::make_unique<Array>(a->capacity() * 2);
+    for (auto i = top; i != b; ++i) {
+      bigger->put(i, a->get(i));
+    }
+    a = bigger.get();
+    arrays_.push_back(std::move(bigger));
+    array_.store(a, std::memory_order_release);
+  }
+  a->put(b, t);
+  std::atomic_thread_fence(std::memory_order_release);
+  bottom_.store(b + 1, std::memory_order_relaxed);
+}
+
+template <typename T>
+auto ChaseLevDeque<T>::pop() noexcept -> T {
+  const auto b = bottom_.load(std::memory_order_relaxed) - 1;
+  auto* a = array_.load(std::memory_order_relaxed);
+  bottom_.store(b, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  auto top = top_.load(std::memory_order_relaxed);
+  auto t = T{nullptr};
+  if (top <= b) {
+    t = a->get(b);
+    if (top == b) {
+      // The last element, race against the thieves for it
+      if (!top_.compare_exchange_strong(top, top + 1,
+                                        std::memory_order_seq_cst,
+                                        std::memory_order_relaxed)) {
+        t = nullptr;
+      }
+      bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+  } else {
+    bottom_.store(b + 1, std::memory_order_relaxed);
+  }
+  return t;
+}
+
+template <typename T>
+auto ChaseLevDeque<T>::steal() noexcept -> T {
+  auto top = top_.load(std::memory_order_acquire);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  const auto b = bottom_.load(std::memory_order_acquire);
+  if (top >= b) {
+    return nullptr;
+  }
+  auto* a = array_.load(std::memory_order_acquire);
+  auto t = a->get(top);
+  if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                    std::memory_order_relaxed)) {
+    return nullptr;
+  }
+  return t;
+}
+
+class WorkStealingPool {
+public:
+  explicit WorkStealingPool(
+      unsigned n_threads = std::max(1u, std::thread::hardware_concurrency()));
+  WorkStealingPool(const WorkStealingPool&) = delete;
+  WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+  ~WorkStealingPool();
+
+  // A pool shared by the whole program
+  static auto global() -> WorkStealingPool& {
+    static auto pool = WorkStealingPool{};
+    return pool;
+  }
+
+  auto size() const noexcept { return workers_.size(); }
+
+  // Runs a() and b(), possibly in parallel, and returns when both have
+  // finished. If any of them throws, the exception is rethrown here.
+  template <typename A, typename B>
+  void fork_join(A&& a, B&& b);
+
+  // Calls f(i) for every i in [0, n), possibly in parallel
+  template <typename F>
+  void parallel_for(std::size_t n, F&& f);
+
+  // Runs f() on a worker and returns when it has finished
+  template <typename F>
+  void run(F&& f);
+
+  // True if the calling worker has forked jobs that nobody has taken yet,
+  // in which case there is no demand for more parallelism
+  auto has_local_work() const noexcept -> bool {
+    return current_pool_ == this && !workers_[current_index_]->deque_.empty();
+  }
+
+  // Number of jobs taken from the deque of another worker
+  auto steal_count() const noexcept {
+    return n_steals_.load(std::memory_order_relaxed);
+  }
+
+private:
+  struct Worker {
+    ChaseLevDeque<Job*> deque_{};
+    std::thread thread_{};
+  };
+
+  auto is_worker() const noexcept { return current_pool_ == this; }
+  void worker_loop(std::size_t index);
+  auto find_job(std::size_t index) noexcept -> Job*;
+  auto pop_injected() -> Job*;
+  auto has_work() const noexcept -> bool;
+  // Called after making new work visible, wakes the sleeping workers
+  void notify_sleepers() noexcept;
+  // Runs other jobs until job is done
+  void help_until_done(const Job& job) noexcept;
+  template <typename F>
+  void parallel_for(std::size_t first, std::size_t last, F& f);
+
+  std::vector<std::unique_ptr<Worker>> workers_{};
+  std::atomic<bool> stop_{false};
+  std::atomic<std::uint32_t> epoch_{0};
+  std::atomic<int> n_sleepers_{0};
+  std::atomic<std::size_t> n_steals_{0};
+
+  // Jobs from threads outside of the pool
+  std::mutex injected_mutex_{};
+  std::condition_variable injected_done_{};
+  std::deque<Job*> injected_{};
+  std::atomic<std::size_t> n_injected_{0};
+
+  inline static thread_local WorkStealingPool* current_pool_ = nullptr;
+  inline static thread_local std::size_t current_index_ = 0;
+
+  static constexpr int idle_spin_count = 64;
+};
+
+inline WorkStealingPool::WorkStealingPool(unsigned n_threads) {
+  n_threads = std::max(1u, n_threads);
+  for (auto i = 0u; i < n_threads; ++i) {
+    workers_.push_back(std::make_unique<Worker>());
+  }
+  // Start the threads when all deques exist, since they steal from each
+  // other
+  for (auto i = 0u; i < n_threads; ++i) {
+    workers_[i]->thread_ = std::thread{[this, i] { worker_loop(i); }};
+  }
+}
+
+inline WorkStealingPool::~WorkStealingPool() {
+  stop_.store(true, std::memory_order_seq_cst);
+  epoch_.fetch_add(1, std::memory_order_seq_cst);
+  epoch_.notify_all();
+  for (auto& w : workers_) {
+    w->thread_.join();
+  }
+}
+
+inline void WorkStealingPool::notify_sleepers() noexcept {
+  // Pairs with the increment of n_sleepers_ in worker_loop(). Either the
+  // sleeper sees the new work, or the sleeper is seen here.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (n_sleepers_.load(std::memory_order_relaxed) > 0) {
+    epoch_.fetch_add(1, std::memory_order_seq_cst);
+    epoch_.notify_all();
+  }
+}
+
+inline auto WorkStealingPool::has_work() const noexcept -> bool {
+  if (n_injected_.load(std::memory_order_seq_cst) > 0) {
+    return true;
+  }
+  return std::any_of(workers_.begin(), workers_.end(),
+                     [](const auto& w) { return !w->deque_.empty(); });
+}
+
+inline auto WorkStealingPool::pop_injected() -> Job* {
+  if (n_injected_.load(std::memory_order_relaxed) == 0) {
+    return nullptr;
+  }
+  auto lock = std::scoped_lock{injected_mutex_};
+  if (injected_.empty()) {
+    return nullptr;
+  }
+  auto* job = injected_.front();
+  injected_.pop_front();
+  n_injected_.fetch_sub(1, std::memory_order_relaxed);
+  return job;
+}
+
+inline auto WorkStealingPool::find_job(std::size_t index) noexcept -> Job* {
+  if (auto* job = workers_[index]->deque_.pop()) {
+    return job;
+  }
+  const auto n = workers_.size();
+  for (auto i = std::size_t{1}; i < n; ++i) {
+    if (auto* job = workers_[(index + i) % n]->deque_.steal()) {
+      n_steals_.fetch_add(1, std::memory_order_relaxed);
+      return job;
+    }
+  }
+  return nullptr;
+}
+
+inline void WorkStealingPool::help_until_done(const Job& job) noexcept {
+  const auto index = current_index_;
+  while (!job.is_done()) {
+    if (auto* other = find_job(index)) {
+      other->run();
+    } else {
+      std::this_thread::yield();
+    }
+  }
+}
+
+inline void WorkStealingPool::worker_loop(std::size_t index) {
+  current_pool_ = this;
+  current_index_ = index;
+  auto n_idle = 0;
+  while (!stop_.load(std::memory_order_relaxed)) {
+    if (auto* job = find_job(index)) {
+      job->run();
+      n_idle = 0;
+    } else if (auto* injected = pop_injected()) {
+      injected->run();
+      // Lock to not notify between the check and the wait of the caller
+      { auto lock = std::scoped_lock{injected_mutex_}; }
+      injected_done_.notify_all();
+      n_idle = 0;
+    } else if (++n_idle < idle_spin_count) {
+      std::this_thread::yield();
+    } else {
+      n_sleepers_.fetch_add(1, std::memory_order_seq_cst);
+      const auto epoch = epoch_.load(std::memory_order_seq_cst);
+      if (!has_work() && !stop_.load(std::memory_order_seq_cst)) {
+        epoch_.wait(epoch, std::memory_order_seq_cst);
+      }
+      n_sleepers_.fetch_sub(1, std::memory_order_relaxed);
+      n_idle = 0;
+    }
+  }
+}
+
+template <typename F>
+void WorkStealingPool::run(F&& f) {
+  if (is_worker()) {
+    f();
+    return;
+  }
+  auto job = Job{f};
+  {
+    auto lock = std::scoped_lock{injected_mutex_};
+    injected_.push_back(&job);
+    n_injected_.fetch_add(1, std::memory_order_relaxed);
+  }
+  notify_sleepers();
+  {
+    auto lock = std::unique_lock{injected_mutex_};
+    injected_done_.wait(lock, [&job] { return job.is_done(); });
+  }
+  job.rethrow_if_failed();
+}
+
+template <typename A, typename B>
+void WorkStealingPool::fork_join(A&& a, B&& b) {
+  if (!is_worker()) {
+    run([&] { fork_join(a, b); });
+    return;
+  }
+  auto job = Job{a};
+  workers_[current_index_]->deque_.push(&job);
+  notify_sleepers();
+  auto exception = std::exception_ptr{};
+  try {
+    b();
+  } catch (...) {
+    exception = std::current_exception();
+  }
+  // Most of the time the job is still in our own deque and is run here
+  help_until_done(job);
+  if (exception) {
+    std::rethrow_exception(exception);
+  }
+  job.rethrow_if_failed();
+}
+
+template <typename F>
+void WorkStealingPool::parallel_for(std::size_t n, F&& f) {
+  if (n > 0) {
+    run([&] { parallel_for(0, n, f); });
+  }
+}
+
+template <typename F>
+void WorkStealingPool::parallel_for(std::size_t first, std::size_t last,
+                                    F& f) {
+  if (last - first == 1) {
+    f(first);
+    return;
+  }
+  const auto middle = first + (last - first) / 2;
+  fork_join([&] { parallel_for(first, middle, f); },
+            [&] { parallel_for(middle, last, f); });
+}
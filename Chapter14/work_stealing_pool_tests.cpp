@@ -0,0 +1,101 @@
+#include "work_stealing_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+auto fib(WorkStealingPool& pool, int n) -> long {
+  if (n < 2) {
+    return n;
+  }
+  auto a = long{0};
+  auto b = long{0};
+  pool.fork_join([&] { a = fib(pool, n - 1); }, [&] { b = fib(pool, n - 2); });
+  return a + b;
+}
+
+} // namespace
+
+TEST(ChaseLevDeque, PopIsLifoAndStealIsFifo) {
+  auto values = std::vector<int>(200);
+  auto deque = ChaseLevDeque<int*>{4}; // Grows while pushing
+  for (auto& v : values) {
+    deque.push(&v);
+  }
+  ASSERT_EQ(deque.steal(), &values.front());
+  ASSERT_EQ(deque.pop(), &values.back());
+  for (auto i = 0; i < 198; ++i) {
+    ASSERT_NE(deque.pop(), nullptr);
+  }
+  ASSERT_EQ(deque.pop(), nullptr);
+  ASSERT_EQ(deque.steal(), nullptr);
+  ASSERT_TRUE(deque.empty());
+}
+
+TEST(ChaseLevDeque, EveryItemIsTakenOnce) {
+  constexpr auto n = 100'000;
+  auto values = std::vector<int>(n, 0);
+  auto deque = ChaseLevDeque<int*>{};
+  auto done = std::atomic<bool>{false};
+  auto thieves = std::vector<std::jthread>{};
+  for (auto i = 0; i < 3; ++i) {
+    thieves.emplace_back([&] {
+      while (!done.load() || !deque.empty()) {
+        if (auto* v = deque.steal()) {
+          std::atomic_ref{*v}.fetch_add(1);
+        }
+      }
+    });
+  }
+  for (auto i = 0; i < n; ++i) {
+    deque.push(&values[i]);
+    if (i % 3 == 0) {
+      if (auto* v = deque.pop()) {
+        std::atomic_ref{*v}.fetch_add(1);
+      }
+    }
+  }
+  while (auto* v = deque.pop()) {
+    std::atomic_ref{*v}.fetch_add(1);
+  }
+  done.store(true);
+  thieves.clear();
+  for (auto v : values) {
+    ASSERT_EQ(v, 1);
+  }
+}
+
+TEST(WorkStealingPool, NestedForkJoin) {
+  auto pool = WorkStealingPool{4};
+  ASSERT_EQ(fib(pool, 20), 6765);
+}
+
+TEST(WorkStealingPool, ParallelFor) {
+  auto pool = WorkStealingPool{3};
+  auto counts = std::vector<int>(1000, 0);
+  pool.parallel_for(counts.size(), [&](size_t i) { ++counts[i]; });
+  for (auto c : counts) {
+    ASSERT_EQ(c, 1);
+  }
+}
+
+TEST(WorkStealingPool, ExceptionsArePropagated) {
+  auto pool = WorkStealingPool{2};
+  auto b_done = false;
+  ASSERT_THROW(pool.fork_join([] { throw std::runtime_error{"a"}; },
+                              [&] { b_done = true; }),
+               std::runtime_error);
+  ASSERT_TRUE(b_done);
+  ASSERT_THROW(pool.parallel_for(100,
+                                 [](size_t i) {
+                                   if (i == 42) {
+                                     throw std::runtime_error{"42"};
+                                   }
+                                 }),
+               std::runtime_error);
+}